@@ -1,10 +1,16 @@
 #include "order_book.h"
+#include "workload.h"
+#include "latency_histogram.h"
 #include <iostream>
 #include <chrono>
 #include <vector>
 #include <random>
 #include <iomanip>
 #include <cmath>
+#include <unordered_map>
+#include <algorithm>
+#include <string>
+#include <cstdio>
 
 using namespace OrderBookSystem;
 
@@ -15,55 +21,22 @@ inline uint64_t get_nanos() {
     ).count();
 }
 
-void run_performance_benchmark() {
-    std::cout << "\n--- Running Performance Benchmark ---\n";
+double run_performance_benchmark(LevelStorage storage, OrderIndexPolicy index, const std::vector<WorkloadOp> &ops) {
+    std::cout << "\n--- Running Performance Benchmark ("
+              << (storage == LevelStorage::Map ? "map" : "ladder") << " levels, "
+              << (index == OrderIndexPolicy::Hash ? "hash" : "slab") << " index) ---\n";
 
     // Create order book with performance-optimized configuration
     OrderBookConfig config(false, 10, 0.01); // Disable verbose logging for performance
+    config.level_storage = storage;
+    config.order_index = index;
     OrderBook book(config);
-    const int num_ops = 5000000;
-    std::vector<Order> orders;
-    orders.reserve(num_ops);
-
-    std::mt19937_64 rng(std::chrono::steady_clock::now().time_since_epoch().count());
-    std::uniform_real_distribution<double> price_dist(95.0, 105.0);
-    std::uniform_int_distribution<uint64_t> quantity_dist(1, 100);
-    std::uniform_int_distribution<int> op_dist(0, 100);
-
-    uint64_t order_id_counter = 1;
-    std::vector<uint64_t> active_order_ids;
-    active_order_ids.reserve(num_ops);
+    const size_t num_ops = ops.size();
 
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    for (int i = 0; i < num_ops; ++i) {
-        int op = op_dist(rng);
-
-        if (op < 60 || active_order_ids.empty()) { // 60% Add
-            bool is_buy = (op % 2 == 0);
-            double price = std::round(price_dist(rng) * 100.0) / 100.0;
-            uint64_t quantity = quantity_dist(rng);
-            uint64_t order_id = order_id_counter++;
-
-            book.add_order({order_id, is_buy, price, quantity, get_nanos()});
-            active_order_ids.push_back(order_id);
-
-        } else if (op < 85) { // 25% Cancel
-             std::uniform_int_distribution<size_t> id_dist(0, active_order_ids.size() - 1);
-             size_t idx = id_dist(rng);
-             uint64_t id_to_cancel = active_order_ids[idx];
-             book.cancel_order(id_to_cancel);
-             std::swap(active_order_ids[idx], active_order_ids.back());
-             active_order_ids.pop_back();
-
-        } else { // 15% Amend
-            std::uniform_int_distribution<size_t> id_dist(0, active_order_ids.size() - 1);
-            size_t idx = id_dist(rng);
-            uint64_t id_to_amend = active_order_ids[idx];
-            double new_price = std::round(price_dist(rng) * 100.0) / 100.0;
-            uint64_t new_quantity = quantity_dist(rng);
-            book.amend_order(id_to_amend, new_price, new_quantity);
-        }
+    for (const WorkloadOp &op : ops) {
+        apply_op(book, op);
     }
 
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -77,8 +50,548 @@ void run_performance_benchmark() {
     std::cout << "Total Time: " << duration.count() << " ms" << std::endl;
     std::cout << "Operations/sec: " << std::fixed << std::setprecision(0) << ops_per_sec << std::endl;
     std::cout << "Avg. Latency/op: " << std::fixed << std::setprecision(2) << latency_ns << " ns" << std::endl;
+    return ops_per_sec;
+}
+
+// Runs the same pre-generated operation stream against each level storage and order index
+void run_level_storage_comparison(const char *name, const WorkloadConfig &workload) {
+    std::cout << "\n===== Workload: " << name << " (seed " << workload.seed << ") =====\n";
+    std::vector<WorkloadOp> ops = WorkloadGenerator(workload).generate(5000000);
+
+    double map_ops = run_performance_benchmark(LevelStorage::Map, OrderIndexPolicy::Hash, ops);
+    double ladder_ops = run_performance_benchmark(LevelStorage::Ladder, OrderIndexPolicy::Hash, ops);
+    double slab_ops = run_performance_benchmark(LevelStorage::Ladder, OrderIndexPolicy::Slab, ops);
+
+    std::cout << "\nLadder vs map throughput: " << std::fixed << std::setprecision(2)
+              << ladder_ops / map_ops << "x" << std::endl;
+    std::cout << "Slab vs hash index throughput (ladder): " << std::fixed << std::setprecision(2)
+              << slab_ops / ladder_ops << "x" << std::endl;
+}
+
+// One call per operation vs apply_batch at several batch sizes, same operation stream
+void run_batch_benchmark(LevelStorage storage) {
+    std::vector<WorkloadOp> ops = WorkloadGenerator(hft_workload(42)).generate(5000000);
+    std::vector<BookCommand> commands;
+    commands.reserve(ops.size());
+    for (const WorkloadOp &op : ops) {
+        CommandType type = op.type == OpType::Add ? CommandType::Add
+                         : op.type == OpType::Cancel ? CommandType::Cancel : CommandType::Amend;
+        commands.push_back({type, op.order});
+    }
+    std::vector<BookCommandResult> results(256); // Reused by every batch, as a caller would
+
+    OrderBookConfig config(false, 10, 0.01);
+    config.level_storage = storage;
+    auto report = [&](const char *name, std::chrono::high_resolution_clock::time_point start) {
+        auto end = std::chrono::high_resolution_clock::now();
+        double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        std::cout << std::setw(24) << std::left << name << std::fixed << std::setprecision(2)
+                  << ns / ops.size() << " ns/op" << std::endl;
+    };
+
+    std::cout << "\n--- Batch Commands (hft workload, "
+              << (storage == LevelStorage::Map ? "map" : "ladder") << " levels) ---\n";
+    {
+        OrderBook book(config);
+        IOrderBook &interface = book;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const WorkloadOp &op : ops) {
+            apply_op(interface, op);
+        }
+        report("one at a time", start);
+    }
+    for (size_t batch : {size_t(1), size_t(16), size_t(256)}) {
+        OrderBook book(config);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < commands.size(); i += batch) {
+            size_t n = std::min(batch, commands.size() - i);
+            book.apply_batch(commands.data() + i, n, results.data());
+        }
+        std::string name = "apply_batch(" + std::to_string(batch) + ")";
+        report(name.c_str(), start);
+    }
+}
+
+// Pre-trade depth queries on a deep book, walking levels vs the cumulative depth index, and
+// the cost of keeping the index up to date on a normal workload
+void run_depth_index_benchmark(LevelStorage storage) {
+    const size_t num_levels = 5000;
+    const size_t num_queries = 200000;
+    std::cout << (storage == LevelStorage::Map ? "map" : "ladder") << " levels:" << std::endl;
+    std::vector<WorkloadOp> ops = WorkloadGenerator(hft_workload(42)).generate(2000000);
+
+    for (bool depth_index : {false, true}) {
+        OrderBookConfig config(false, 10, 0.01);
+        config.level_storage = storage;
+        config.depth_index = depth_index;
+        config.ladder_capacity = 2 * num_levels;
+        OrderBook book(config);
+        for (size_t i = 0; i < num_levels; ++i) {
+            book.add_order({2 * i + 1, true, 1000.0 - 0.01 * i, 100, 0});
+            book.add_order({2 * i + 2, false, 1000.01 + 0.01 * i, 100, 0});
+        }
+
+        std::mt19937_64 rng(7);
+        std::uniform_int_distribution<size_t> level(0, num_levels - 1);
+        std::vector<double> limits(num_queries);
+        for (double &limit : limits) {
+            limit = 1000.01 + 0.01 * level(rng);
+        }
+        uint64_t sink = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (double limit : limits) {
+            sink += book.depth_at_or_better(false, limit);
+        }
+        auto mid = std::chrono::high_resolution_clock::now();
+        for (double limit : limits) {
+            sink += book.estimate_fill(true, 100 * num_levels / 2, limit).quantity;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double depth_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(mid - start).count() / double(num_queries);
+        double fill_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid).count() / double(num_queries);
+
+        OrderBook workload_book(config);
+        start = std::chrono::high_resolution_clock::now();
+        for (const WorkloadOp &op : ops) {
+            apply_op(workload_book, op);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double op_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(ops.size());
+
+        std::cout << "  " << std::setw(12) << std::left << (depth_index ? "depth index" : "level walk")
+                  << std::fixed << std::setprecision(1) << "depth query " << depth_ns << " ns, estimate_fill "
+                  << fill_ns << " ns, hft workload " << op_ns << " ns/op" << (sink == 0 ? " (empty)" : "")
+                  << std::endl;
+    }
+}
+
+// Latency of one aggressive buy that takes `levels` whole ask levels of 10 orders each, refilled
+// before every sweep; with a listener each level's fills are reported as one batch
+void run_deep_sweep_benchmark(size_t levels, bool listen) {
+    const size_t num_sweeps = 20000;
+    const size_t orders_per_level = 10;
+    OrderBookConfig config(false, 10, 0.01);
+    config.level_storage = LevelStorage::Ladder;
+    OrderBook book(config);
+    ExecutionReportBuffer reports(levels * orders_per_level);
+    if (listen) {
+        book.set_execution_listener(&reports);
+    }
+    book.add_order({1, true, 99.00, 100, 0});
+
+    LatencyHistogram latency;
+    uint64_t id = 2;
+    for (size_t sweep = 0; sweep < num_sweeps; ++sweep) {
+        uint64_t quantity = 0;
+        for (size_t level = 0; level < levels; ++level) {
+            for (size_t i = 0; i < orders_per_level; ++i) {
+                book.add_order({id++, false, 100.00 + level * 0.01, 1 + i % 3, 0});
+                quantity += 1 + i % 3;
+            }
+        }
+        reports.clear();
+        uint64_t start = get_nanos();
+        book.add_order({id++, true, 100.00 + levels * 0.01, quantity, 0});
+        latency.record(get_nanos() - start);
+    }
+
+    std::cout << std::setw(4) << std::right << levels << " levels" << (listen ? ", listener   " : ", no listener")
+              << std::fixed << std::setprecision(1) << "  p50 " << std::setw(8) << double(latency.percentile(50.0))
+              << " ns  p99 " << std::setw(8) << double(latency.percentile(99.0))
+              << " ns  max " << std::setw(9) << double(latency.max())
+              << " ns  | " << std::setprecision(2) << latency.mean() / (levels * orders_per_level) << " ns/fill"
+              << std::endl;
+}
+
+// Pulling one participant's 100k resting orders out of a 200k-order book: cancel_order per ID,
+// mass_cancel by owner, and mass_cancel of a price range holding 100k orders of every owner
+void run_mass_cancel_benchmark(LevelStorage storage) {
+    const size_t num_orders = 200000;
+    const int num_levels = 500;
+    std::cout << (storage == LevelStorage::Map ? "map" : "ladder") << " levels:" << std::endl;
+
+    for (int mode = 0; mode < 3; ++mode) {
+        OrderBookConfig config(false, 10, 0.01);
+        config.level_storage = storage;
+        config.expected_orders = num_orders;
+        OrderBook book(config);
+        // Owner 1 holds every other order; owners 2..9 share the rest
+        for (uint64_t id = 1; id <= num_orders; ++id) {
+            bool is_buy = (id & 2) != 0;
+            int level = static_cast<int>((id >> 2) % num_levels);
+            uint32_t owner = (id & 1) != 0 ? 1 : 2 + static_cast<uint32_t>((id >> 1) % 8);
+            book.add_order({id, is_buy, is_buy ? 99.99 - level * 0.01 : 100.00 + level * 0.01, 10, id, owner});
+        }
+
+        size_t cancelled = 0;
+        auto start = std::chrono::high_resolution_clock::now();
+        if (mode == 0) {
+            for (uint64_t id = 1; id <= num_orders; id += 2) {
+                cancelled += book.cancel_order(id);
+            }
+        } else if (mode == 1) {
+            cancelled = book.mass_cancel({1, true, true});
+        } else {
+            MassCancelRequest request;
+            request.min_price = 99.99 - (num_levels / 2 - 1) * 0.01;
+            request.max_price = 100.00 + (num_levels / 2 - 1) * 0.01;
+            cancelled = book.mass_cancel(request);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        const char *names[] = {"cancel_order per ID", "mass_cancel by owner", "mass_cancel by range"};
+        std::cout << "  " << std::setw(22) << std::left << names[mode] << std::fixed << std::setprecision(2)
+                  << cancelled << " orders in " << ns / 1e6 << " ms, " << ns / cancelled << " ns/order" << std::endl;
+    }
+}
+
+// One order per level on both sides of a fully crossed book, as built up during a call
+void run_auction_benchmark(LevelStorage storage, int num_levels) {
+    OrderBookConfig config(false, 10, 0.01);
+    config.level_storage = storage;
+    config.expected_orders = 2 * num_levels;
+    OrderBook book(config);
+    book.begin_auction();
+    uint64_t id = 0;
+    for (int level = 0; level < num_levels; ++level) {
+        ++id;
+        book.add_order({id, true, 100.00 + level * 0.01, 10, id});
+        ++id;
+        book.add_order({id, false, 100.00 + level * 0.01, static_cast<uint64_t>(10 + level % 3), id});
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    AuctionResult indicative = book.indicative_uncross();
+    auto middle = std::chrono::high_resolution_clock::now();
+    AuctionResult result = book.uncross();
+    auto end = std::chrono::high_resolution_clock::now();
+    double indicative_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(middle - start).count();
+    double uncross_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - middle).count();
+
+    std::cout << (storage == LevelStorage::Map ? "map   " : "ladder") << " levels, " << num_levels
+              << " per side: equilibrium " << std::fixed << std::setprecision(2) << indicative.price
+              << ", volume " << result.volume << "; indicative " << indicative_ns / 1e6 << " ms, uncross "
+              << uncross_ns / 1e6 << " ms" << std::endl;
+}
+
+// Counts trades; reached virtually through ListenerEventSink, directly through DirectEventSink
+class TradeCounter : public ExecutionListener {
+public:
+    uint64_t trades = 0;
+    void on_execution(const ExecutionReport &report) override {
+        trades += (report.type == ExecutionType::Trade);
+    }
+};
+
+// Time one book type over ops, calling it through Api (the book itself, or an interface)
+template<typename Book, typename Api = Book, typename Setup>
+double time_policy_book(const char *name, const std::vector<WorkloadOp> &ops, Setup setup) {
+    OrderBookConfig config(false, 10, 0.01);
+    config.level_storage = LevelStorage::Ladder; // Configured books match the fixed ladder/hash ones
+    Book book(config);
+    setup(book);
+    Api &api = book;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const WorkloadOp &op : ops) {
+        apply_op(api, op);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / double(ops.size());
+    std::cout << std::setw(40) << std::left << name << std::fixed << std::setprecision(2)
+              << ns << " ns/op" << std::endl;
+    return ns;
+}
+
+// The same operation stream through OrderBook and through BasicOrderBook instantiations with
+// every policy fixed at compile time
+void run_policy_benchmark() {
+    std::vector<WorkloadOp> ops = WorkloadGenerator(hft_workload(42)).generate(5000000);
+    auto none = [](auto &) {};
+    TradeCounter listener_trades, direct_trades;
+
+    std::cout << "\n--- Compile-Time Policies (hft workload) ---\n";
+    double base = time_policy_book<OrderBook, IOrderBook>("OrderBook via IOrderBook&", ops, none);
+    time_policy_book<ConfiguredOrderBook>("ConfiguredOrderBook (run-time config)", ops, none);
+    double fixed = time_policy_book<BasicOrderBook<FixedTickPrice<100>, LadderLevels, HashIdIndex, NullEventSink>>(
+        "fixed ladder / hash / null sink", ops, none);
+    time_policy_book<BasicOrderBook<FixedTickPrice<100>, LadderLevels, SlabIdIndex, NullEventSink>>(
+        "fixed ladder / slab / null sink", ops, none);
+    time_policy_book<BasicOrderBook<FixedTickPrice<100>, MapLevels, HashIdIndex, NullEventSink>>(
+        "fixed map / hash / null sink", ops, none);
+    time_policy_book<BasicOrderBook<FixedTickPrice<100>, LadderLevels, HashIdIndex, ListenerEventSink>>(
+        "fixed ladder / hash / listener sink", ops,
+        [&](auto &book) { book.set_execution_listener(&listener_trades); });
+    time_policy_book<BasicOrderBook<FixedTickPrice<100>, LadderLevels, HashIdIndex, DirectEventSink<TradeCounter>>>(
+        "fixed ladder / hash / direct sink", ops,
+        [&](auto &book) { book.event_sink().set_handler(&direct_trades); });
+    std::cout << "Fully fixed vs OrderBook: " << std::fixed << std::setprecision(2) << base / fixed << "x"
+              << " (trades seen: listener " << listener_trades.trades << ", direct " << direct_trades.trades << ")"
+              << std::endl;
+}
+
+// Levels created and destroyed at the touch: each add opens a new level inside the spread and
+// each cancel empties one, over a fixed background book
+void run_level_churn_benchmark(LevelStorage storage) {
+    const size_t num_rounds = 2000000;
+    const size_t outstanding = 16;
+    OrderBookConfig config(false, 10, 0.01);
+    config.level_storage = storage;
+    OrderBook book(config);
+    uint64_t id = 1;
+    for (int level = 0; level < 100; ++level) {
+        book.add_order({id++, true, 99.50 - level * 0.01, 100, 0});
+        book.add_order({id++, false, 100.50 + level * 0.01, 100, 0});
+    }
+
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> live(outstanding, 0);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t round = 0; round < num_rounds; ++round) {
+        size_t slot = round % outstanding;
+        if (live[slot] != 0) {
+            book.cancel_order(live[slot]);
+        }
+        bool is_buy = (rng() & 1) != 0;
+        int tick = 1 + static_cast<int>(rng() % 49);
+        live[slot] = id;
+        book.add_order({id++, is_buy, is_buy ? 99.50 + tick * 0.01 : 100.50 - tick * 0.01, 10, 0});
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::cout << std::setw(8) << std::left << (storage == LevelStorage::Map ? "map" : "ladder")
+              << std::fixed << std::setprecision(2) << ns / num_rounds << " ns per add+cancel" << std::endl;
+}
+
+// Resident bytes of this process, from /proc/self/statm (0 where unavailable)
+size_t resident_bytes() {
+    std::FILE *statm = std::fopen("/proc/self/statm", "r");
+    if (statm == nullptr) {
+        return 0;
+    }
+    unsigned long pages = 0, resident = 0;
+    int fields = std::fscanf(statm, "%lu %lu", &pages, &resident);
+    std::fclose(statm);
+    return fields == 2 ? resident * 4096 : 0;
+}
+
+// Memory per resting order and sweep speed on a 10M-order book (5M per side over 1000 levels)
+void run_node_layout_benchmark(OrderIndexPolicy index) {
+    const size_t num_orders = 10000000;
+    const int num_levels = 1000;
+    OrderBookConfig config(false, 10, 0.01);
+    config.level_storage = LevelStorage::Ladder;
+    config.order_index = index;
+    config.expected_orders = num_orders;
+    config.slab_window_orders = num_orders * 2;
+
+    size_t rss_before = resident_bytes();
+    OrderBook book(config);
+    for (uint64_t id = 1; id <= num_orders; ++id) {
+        bool is_buy = (id & 1) != 0;
+        int level = static_cast<int>((id >> 1) % num_levels);
+        book.add_order({id, is_buy, is_buy ? 99.99 - level * 0.01 : 100.00 + level * 0.01, 1 + id % 7, id});
+    }
+    size_t rss_after = resident_bytes();
+
+    // One buy takes every ask, level by level and order by order
+    auto start = std::chrono::high_resolution_clock::now();
+    book.add_order({num_orders + 1, true, 100.00 + num_levels * 0.01, UINT64_MAX / 2, 0});
+    auto end = std::chrono::high_resolution_clock::now();
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    MemoryPoolStats pool = book.memory_pool_stats();
+    std::cout << std::setw(6) << std::left << (index == OrderIndexPolicy::Hash ? "hash" : "slab")
+              << std::fixed << std::setprecision(1)
+              << " resident: " << static_cast<double>(rss_after - rss_before) / num_orders << " B/order"
+              << " | node pool: " << static_cast<double>(pool.bytes) / pool.capacity << " B/slot"
+              << " | sweep: " << std::setprecision(2) << ns / (num_orders / 2) << " ns/order filled" << std::endl;
+}
+
+// Market data publishing after every operation: full top-10 snapshot vs incremental updates
+// applied to a mirror book
+void run_market_data_benchmark() {
+    const size_t depth = 10;
+    std::vector<WorkloadOp> ops = WorkloadGenerator(hft_workload(42)).generate(2000000);
+    std::vector<PriceLevel> bids, asks;
+
+    auto time_ops = [&](const char *name, bool snapshot, LevelUpdateListener *mirror) {
+        OrderBookConfig config(false, depth, 0.01);
+        config.level_storage = LevelStorage::Ladder;
+        OrderBook book(config);
+        book.set_level_update_listener(mirror, depth);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const WorkloadOp &op : ops) {
+            apply_op(book, op);
+            if (snapshot) {
+                book.get_snapshot(depth, bids, asks);
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+        std::cout << std::setw(24) << std::left << name << std::fixed << std::setprecision(2)
+                  << ns / ops.size() << " ns/op" << std::endl;
+    };
+
+    std::cout << "\n--- Market Data Publishing (hft workload, top " << depth << ") ---\n";
+    L2MirrorBook mirror(depth);
+    time_ops("book only", false, nullptr);
+    time_ops("snapshot per op", true, nullptr);
+    time_ops("level updates + mirror", false, &mirror);
+}
+
+// Empties deep, sparse books level by level, so every removal has to find the next best level
+void run_sparse_book_benchmark(LevelStorage storage) {
+    const int num_levels = 5000;
+    const int tick_gap = 37;       // Empty ticks between populated levels
+    const int num_rounds = 20;
+
+    OrderBookConfig config(false, 10, 0.01);
+    config.level_storage = storage;
+    OrderBook book(config);
+
+    std::vector<PriceLevel> bids, asks;
+    uint64_t order_id = 1;
+    long long sweep_ns = 0, cancel_ns = 0, snapshot_ns = 0;
+
+    for (int round = 0; round < num_rounds; ++round) {
+        uint64_t first_bid_id = order_id;
+        for (int i = 0; i < num_levels; ++i) {
+            book.add_order({order_id++, true, 999.99 - i * tick_gap * 0.01, 1, 0});
+        }
+        for (int i = 0; i < num_levels; ++i) {
+            book.add_order({order_id++, false, 1000.00 + i * tick_gap * 0.01, 1, 0});
+        }
+
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < 100; ++i) {
+            book.get_snapshot(100, bids, asks);
+        }
+        auto t1 = std::chrono::high_resolution_clock::now();
+
+        // One aggressive buy sweeps every ask level
+        book.add_order({order_id++, true, 1000.00 + num_levels * tick_gap * 0.01, (uint64_t)num_levels, 0});
+        auto t2 = std::chrono::high_resolution_clock::now();
+
+        // Cancel bids best first, so each cancel removes the best level
+        for (int i = 0; i < num_levels; ++i) {
+            book.cancel_order(first_bid_id + i);
+        }
+        auto t3 = std::chrono::high_resolution_clock::now();
+
+        snapshot_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        sweep_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count();
+        cancel_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(t3 - t2).count();
+    }
+
+    double levels = static_cast<double>(num_levels) * num_rounds;
+    std::cout << std::setw(8) << std::left << (storage == LevelStorage::Map ? "map" : "ladder")
+              << std::fixed << std::setprecision(2)
+              << " sweep: " << sweep_ns / levels << " ns/level"
+              << " | cancel best: " << cancel_ns / levels << " ns/level"
+              << " | snapshot(100): " << snapshot_ns / (100.0 * num_rounds) << " ns" << std::endl;
 }
 
+// Allocator that tallies live bytes, to measure std::unordered_map memory
+size_t g_counted_bytes = 0;
+
+template<typename T>
+struct CountingAllocator {
+    using value_type = T;
+    CountingAllocator() = default;
+    template<typename U> CountingAllocator(const CountingAllocator<U>&) {}
+    T* allocate(size_t n) {
+        g_counted_bytes += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, size_t n) {
+        g_counted_bytes -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+    }
+    template<typename U> bool operator==(const CountingAllocator<U>&) const { return true; }
+    template<typename U> bool operator!=(const CountingAllocator<U>&) const { return false; }
+};
+
+// Fills an order ID index, then cancels every entry in random order (lookup + erase)
+template<typename Index, typename Insert, typename Cancel>
+void time_order_index(const char* name, Index &index, const std::vector<uint64_t> &ids,
+                      const std::vector<uint64_t> &cancel_order, size_t memory_bytes,
+                      Insert insert, Cancel cancel) {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (uint64_t id : ids) {
+        insert(index, id);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    size_t found = 0;
+    for (uint64_t id : cancel_order) {
+        found += cancel(index, id);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    double insert_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() / (double)ids.size();
+    double cancel_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count() / (double)ids.size();
+    std::cout << std::setw(20) << std::left << name << std::fixed << std::setprecision(2)
+              << " insert: " << insert_ns << " ns | cancel: " << cancel_ns << " ns"
+              << " | memory: " << memory_bytes / (1024.0 * 1024.0) << " MiB ("
+              << (double)memory_bytes / ids.size() << " B/order)"
+              << (found == ids.size() ? "" : " MISMATCH") << std::endl;
+}
+
+void run_order_index_benchmark() {
+    const size_t num_orders = 1000000;
+    std::cout << "\n--- Order ID Index (" << num_orders << " resting orders) ---\n";
+
+    std::vector<uint64_t> ids(num_orders);
+    for (size_t i = 0; i < num_orders; ++i) {
+        ids[i] = i * 3 + 1; // Sequential with gaps, as left behind by immediately filled orders
+    }
+    std::vector<uint64_t> cancel_order = ids;
+    std::shuffle(cancel_order.begin(), cancel_order.end(), std::mt19937_64(7));
+    NodeIndex dummy = 1;
+
+    {
+        using StdMap = std::unordered_map<uint64_t, NodeIndex, std::hash<uint64_t>, std::equal_to<uint64_t>,
+                                          CountingAllocator<std::pair<const uint64_t, NodeIndex>>>;
+        StdMap index;
+        // Measure at full size, then rebuild so timing starts from an empty map
+        for (uint64_t id : ids) index[id] = dummy;
+        size_t bytes = g_counted_bytes;
+        index.clear();
+        time_order_index("std::unordered_map", index, ids, cancel_order, bytes,
+            [&](StdMap &m, uint64_t id) { m[id] = dummy; },
+            [](StdMap &m, uint64_t id) {
+                auto it = m.find(id);
+                if (it == m.end()) return 0;
+                m.erase(it);
+                return 1;
+            });
+    }
+    {
+        OrderIdMap index(num_orders);
+        time_order_index("OrderIdMap", index, ids, cancel_order, index.memory_bytes(),
+            [&](OrderIdMap &m, uint64_t id) { m.insert(id, dummy); },
+            [](OrderIdMap &m, uint64_t id) {
+                if (m.find(id) == kNoNode) return 0;
+                m.erase(id);
+                return 1;
+            });
+    }
+    {
+        OrderIdSlab index;
+        for (uint64_t id : ids) index.insert(id, dummy);
+        size_t bytes = index.memory_bytes();
+        index.clear();
+        time_order_index("OrderIdSlab", index, ids, cancel_order, bytes,
+            [&](OrderIdSlab &m, uint64_t id) { m.insert(id, dummy); },
+            [](OrderIdSlab &m, uint64_t id) {
+                if (m.find(id) == kNoNode) return 0;
+                m.erase(id);
+                return 1;
+            });
+    }
+}
 
 int main() {
     // --- Correctness and Matching Test ---
@@ -122,7 +635,49 @@ int main() {
     book.print_book();
 
     // --- Performance Test ---
-    run_performance_benchmark();
+    run_level_storage_comparison("uniform", uniform_workload(42));
+    run_level_storage_comparison("hft", hft_workload(42));
+
+    std::cout << "\n--- Sparse Book Emptying (5000 levels, 37-tick gaps) ---\n";
+    run_sparse_book_benchmark(LevelStorage::Map);
+    run_sparse_book_benchmark(LevelStorage::Ladder);
+
+    run_order_index_benchmark();
+
+    run_market_data_benchmark();
+
+    run_batch_benchmark(LevelStorage::Map);
+    run_batch_benchmark(LevelStorage::Ladder);
+
+    run_policy_benchmark();
+
+    std::cout << "\n--- Cumulative Depth (5000 levels per side; queries over random limits) ---\n";
+    run_depth_index_benchmark(LevelStorage::Map);
+    run_depth_index_benchmark(LevelStorage::Ladder);
+
+    std::cout << "\n--- Deep Sweeps (one buy takes N whole ask levels, 10 orders each) ---\n";
+    for (size_t levels : {1, 20, 100}) {
+        run_deep_sweep_benchmark(levels, false);
+        run_deep_sweep_benchmark(levels, true);
+    }
+
+    std::cout << "\n--- Mass Cancel (100k of 200k resting orders over 500 levels per side) ---\n";
+    run_mass_cancel_benchmark(LevelStorage::Map);
+    run_mass_cancel_benchmark(LevelStorage::Ladder);
+
+    std::cout << "\n--- Call Auction Uncross (fully crossed book) ---\n";
+    for (int levels : {10000, 50000}) {
+        run_auction_benchmark(LevelStorage::Map, levels);
+        run_auction_benchmark(LevelStorage::Ladder, levels);
+    }
+
+    std::cout << "\n--- Level Churn (levels opened and emptied at the touch) ---\n";
+    run_level_churn_benchmark(LevelStorage::Map);
+    run_level_churn_benchmark(LevelStorage::Ladder);
+
+    std::cout << "\n--- Node Layout (10M resting orders, ladder levels) ---\n";
+    run_node_layout_benchmark(OrderIndexPolicy::Hash);
+    run_node_layout_benchmark(OrderIndexPolicy::Slab);
 
     return 0;
 }
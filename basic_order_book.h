@@ -0,0 +1,1507 @@
+#pragma once
+
+#include "common.h"
+#include "order_book_config.h"
+#include "book_policies.h"
+#include "memory_pool.h"
+#include "price_level.h"
+#include "order_node_pool.h"
+#include "price_level_pool.h"
+#include "execution_report.h"
+#include "level_update.h"
+#include "top_of_book.h"
+#include "journal.h"
+#include "checkpoint.h"
+#include "depth_index.h"
+#include "order_id_map.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace OrderBookSystem {
+
+// Non-template parts of the book, shared by every instantiation (Order_Book.cpp)
+namespace book_detail {
+
+// Whole checkpoint file in memory, with its header checked
+bool read_checkpoint_file(const std::string &path, std::vector<char> &data, CheckpointHeader &header,
+                          bool header_only);
+bool read_checkpoint_info(const std::string &path, CheckpointInfo &info);
+// The config a checkpoint header records
+OrderBookConfig checkpoint_config(const CheckpointHeader &header);
+void print_book(const std::vector<PriceLevel> &bids, const std::vector<PriceLevel> &asks);
+
+inline MemoryPoolConfig pool_config(const OrderBookConfig &config) {
+    MemoryPoolConfig pool;
+    pool.reserve_objects = config.expected_orders;
+    pool.huge_pages = config.pool_huge_pages;
+    pool.prefault = config.pool_prefault;
+    return pool;
+}
+
+} // namespace book_detail
+
+// The order book with its moving parts fixed at compile time (see book_policies.h):
+//   PricePolicy     converts API prices to ticks (RuntimeTickPrice, FixedTickPrice<N>)
+//   LevelContainer  orders each side's levels (MapLevels, LadderLevels, ConfiguredLevels)
+//   IdIndex         maps order IDs to nodes (HashIdIndex, SlabIdIndex, ConfiguredIdIndex)
+//   EventSink       receives execution reports (NullEventSink, ListenerEventSink, DirectEventSink)
+// Every call is non-virtual and a fixed policy has no run-time dispatch left on the hot path.
+// With a NullEventSink the book builds no reports and has no market data or journal hooks.
+// The config's price_precision, level_storage and order_index are overridden by fixed
+// policies, so get_config() always describes the book as built.
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+class BasicOrderBook {
+public:
+    explicit BasicOrderBook(const OrderBookConfig& config = OrderBookConfig{});
+
+    BasicOrderBook(const BasicOrderBook&) = delete;
+    BasicOrderBook& operator=(const BasicOrderBook&) = delete;
+
+    void add_order(const Order &order);
+    // Add with a time in force; returns the quantity traded on entry. The unfilled part of an
+    // IOC order, or a whole FOK order that cannot fill on entry, is reported as Cancelled and
+    // never rests. FOK is decided before matching starts: by the depth index when there is one.
+    uint64_t add_order(const Order &order, TimeInForce time_in_force);
+    bool cancel_order(uint64_t order_id);
+    // Cancel every resting order request selects, reporting each as Cancelled and journaling
+    // each as a cancel. With an owner only that owner's orders are visited; without one, whole
+    // levels in the price range are retired at once. Returns the number of orders cancelled.
+    size_t mass_cancel(const MassCancelRequest &request);
+    // Amend in place: the order keeps its node and index entry. At the same price a size-down
+    // keeps time priority and a size-up follows config.amend_priority; a new price goes to the
+    // back of the new level, trading first if it crosses.
+    bool amend_order(uint64_t order_id, double new_price, uint64_t new_quantity);
+    void get_snapshot(size_t depth, std::vector<PriceLevel> &bids, std::vector<PriceLevel> &asks) const;
+    void print_book(size_t depth = 10) const;
+    void set_verbose(bool enabled) {
+        config_.verbose_logging = enabled;
+        sink_.set_verbose(enabled);
+    }
+
+    // The sink, e.g. to attach a DirectEventSink's handler
+    EventSink& event_sink() { return sink_; }
+
+    // ListenerEventSink only: receives trades, resting acks, cancel acks and amend acks;
+    // nullptr disables reporting. Verbose logging prints trades independently of the listener.
+    void set_execution_listener(ExecutionListener *listener) { sink_.set_listener(listener); }
+
+    // Publishes incremental updates for the top depth levels of each side; nullptr disables
+    // them. Attaching first sends the current top levels as New updates.
+    void set_level_update_listener(LevelUpdateListener *listener, size_t depth);
+
+    // Publishes the top top_of_book->depth() levels after every operation that changed a level,
+    // for lock-free reads from other threads; nullptr disables it. Attaching publishes at once.
+    void set_top_of_book(TopOfBook *top_of_book);
+
+    // Appends every accepted add, cancel and amend to journal before applying it; nullptr
+    // disables journaling. Detach before replaying a journal into this book.
+    void set_journal(JournalWriter *journal) {
+        static_assert(EventSink::kEnabled, "journaling needs an enabled event sink");
+        journal_ = journal;
+    }
+
+    // Apply count commands in order with one call, writing one result per command to results
+    // (which may be nullptr). Index slots and ladder levels are prefetched a few commands
+    // ahead, and the top of book is published once at the end of the batch rather than after
+    // each command. Returns the number of accepted commands.
+    size_t apply_batch(const BookCommand *commands, size_t count, BookCommandResult *results);
+
+    // L3 checkpoint: the config and every resting order, in FIFO order per level. Take it on
+    // the owning thread between operations; it also records the attached journal's length so
+    // recovery can replay only the journal tail. load_checkpoint rebuilds levels and orders
+    // directly, without matching; the book must be empty and use the checkpoint's
+    // price_precision (construct it from read_checkpoint_info). Both return false on I/O or
+    // format errors (including a zero quantity or an order ID saved twice), leaving an empty
+    // book on a failed load.
+    bool save_checkpoint(const std::string &path) const;
+    bool load_checkpoint(const std::string &path);
+    static bool read_checkpoint_info(const std::string &path, CheckpointInfo &info) {
+        return book_detail::read_checkpoint_info(path, info);
+    }
+
+    // Call auctions. begin_auction stops matching: adds and amends rest even when they cross
+    // (IOC and FOK adds are cancelled in full), so the book may be crossed until uncross.
+    // uncross trades every crossing order at the equilibrium price in price-time priority and
+    // resumes continuous matching. indicative_uncross is the result uncross would give now;
+    // it is one merge pass over the crossed levels, picking the price with the most volume,
+    // then the smallest imbalance, then the highest price if buyers are left over at every
+    // such price or the lowest if sellers are, and otherwise the middle of the range.
+    void begin_auction();
+    AuctionResult uncross();
+    AuctionResult indicative_uncross() const;
+    bool in_auction() const { return auction_; }
+
+    // Pre-trade depth. depth_at_or_better is the quantity resting on side is_buy at price or
+    // better; estimate_fill is what an aggressive order on side is_buy would take from the
+    // opposite side, best level first, within limit. Both are O(log n) with config.depth_index
+    // and walk the levels otherwise. They describe the resting book: a sell in this book only
+    // ever trades with the head bid at its own price (see match_sell_order).
+    uint64_t depth_at_or_better(bool is_buy, double price) const;
+    FillEstimate estimate_fill(bool is_buy, uint64_t quantity, double limit) const;
+
+    size_t order_count() const { return order_lookup_.size(); }
+    MemoryPoolStats memory_pool_stats() const { return order_pool_.stats(); }
+    MemoryPoolStats level_pool_stats() const { return level_pool_.stats(); }
+
+    // Copy the resting order with this ID (remaining quantity, level price, entry timestamp)
+    // into order; false if it is not resting.
+    bool find_order(uint64_t order_id, Order &order) const;
+
+    // Configuration access
+    const OrderBookConfig& get_config() const { return config_; }
+    void update_config(const OrderBookConfig& new_config); // price_precision, level storage, order index and pool options cannot change
+
+private:
+    OrderBookConfig config_;
+    PricePolicy price_;
+    PriceLevelPool level_pool_; // Before levels_, which allocates from it
+    LevelContainer levels_;
+    IdIndex order_lookup_;
+    OrderNodePool order_pool_;
+    EventSink sink_;
+    LevelUpdateListener *level_listener_;
+    size_t feed_depth_;
+    std::vector<PriceTicks> top_levels_[2]; // Prices of the published levels, [is_buy], best first
+    TopOfBook *top_of_book_;
+    bool levels_changed_;                   // A published level changed since the last publish
+    size_t top_of_book_count_[2];           // Levels published per side, [is_buy]
+    PriceTicks top_of_book_worst_[2];       // Deepest published price per side, [is_buy]
+    JournalWriter *journal_;
+    bool depth_enabled_;
+    CumulativeDepth depth_[2];              // Cumulative quantity per side, [is_buy], with config.depth_index
+    LevelIndex last_level_;                 // Level of the last resting add, reused by bursts at one price
+    bool last_level_is_buy_;
+    OrderIdMap owner_heads_;                // Owner ID to its newest resting order
+    size_t owned_orders_;                   // Resting orders with an owner
+    static constexpr size_t kReportBatch = 64;
+    ExecutionReport batched_reports_[kReportBatch]; // Reports of a level swept or cancelled whole
+    size_t batched_;
+    bool auction_;                          // In an auction call: nothing matches until uncross
+    struct AuctionLevel {
+        PriceTicks price;
+        uint64_t quantity;
+    };
+    mutable std::vector<AuctionLevel> auction_levels_[2]; // Crossed levels per side, [is_buy], best first
+
+    // Internal helper methods
+    uint64_t enter_order(const Order &order, TimeInForce time_in_force = TimeInForce::Day); // Returns the quantity traded
+    bool fills_on_entry(const Order &order, PriceTicks limit) const;
+    uint64_t depth_at_or_better_ticks(bool is_buy, PriceTicks price) const;
+    void cancel_resting_order(NodeIndex node);
+    uint64_t amend_resting_order(NodeIndex node, double new_price, uint64_t new_quantity);
+    void prefetch_command(const BookCommand &command) const;
+    void remove_resting_order(NodeIndex node);
+    NodeIndex create_order_node(const Order& order);
+    void cleanup_order_node(NodeIndex node);
+    Order resting_order(NodeIndex node) const;
+    void link_owner(NodeIndex node);
+    void unlink_owner(NodeIndex node);
+    void prefetch_queue_ahead(const OrderNodeHot &node);
+    void discard_loaded_orders();
+    PriceTicks range_bound(double price, bool round_up) const;
+    // The attached journal; always nullptr without an enabled sink, so journaling compiles out
+    JournalWriter* journal() const { return EventSink::kEnabled ? journal_ : nullptr; }
+
+    // Price level management
+    void add_order_to_price_level_queue(NodeIndex node, LevelIndex level);
+    void remove_order_from_price_level_queue(NodeIndex node);
+    LevelIndex find_or_create_price_level(PriceTicks price, bool is_buy);
+    void remove_empty_price_level(PriceTicks price, bool is_buy);
+    void remove_best_price_level(bool is_buy);
+    void requeue_at_tail(NodeIndex node);
+
+    // Matching engine
+    void match_aggressive_order(Order &order, PriceTicks limit);
+    bool crosses(bool is_buy, PriceTicks limit) const;
+    void match_buy_order(Order &order, PriceTicks limit);
+    void match_sell_order(Order &order, PriceTicks limit);
+    void sweep_level(Order &order, PriceLevelQueue &level, bool is_buy);
+    size_t cancel_level(PriceLevelQueue &level, bool is_buy);
+    void clear_level(PriceLevelQueue &level, bool is_buy, size_t orders);
+    void match_orders(PriceTicks price);
+    bool find_equilibrium(PriceTicks &price, uint64_t &volume, int64_t &imbalance) const;
+
+    // Execution reporting; reports are only built when the sink is listening
+    bool reporting() const { return sink_.reporting(); }
+    void report_trade(const Order &aggressor, const OrderNodeHot &resting, PriceTicks price, uint64_t quantity);
+    void report(const ExecutionReport &report) { sink_.report(report); }
+    void report_batched(const ExecutionReport &report) {
+        batched_reports_[batched_++] = report;
+        if (batched_ == kReportBatch) {
+            flush_reports();
+        }
+    }
+    void flush_reports() {
+        if (batched_ > 0) {
+            sink_.report_batch(batched_reports_, batched_);
+            batched_ = 0;
+        }
+    }
+
+    // Market data; called after every change to a level's total quantity
+    void level_changed(const PriceLevelQueue &level, bool is_buy) {
+        if (depth_enabled_) {
+            depth_[is_buy].set(level.price, level.total_quantity);
+        }
+        if constexpr (EventSink::kEnabled) {
+            if (level_listener_ != nullptr) {
+                publish_level(level, is_buy);
+            }
+            if (top_of_book_ != nullptr && !levels_changed_) {
+                // Levels deeper than a full published view cannot change it
+                levels_changed_ = top_of_book_count_[is_buy] < top_of_book_->depth() ||
+                                  (is_buy ? level.price >= top_of_book_worst_[is_buy]
+                                          : level.price <= top_of_book_worst_[is_buy]);
+            }
+        }
+    }
+    // Called at the end of each public operation
+    void operation_done() {
+        if constexpr (EventSink::kEnabled) {
+            if (top_of_book_ != nullptr && levels_changed_) {
+                publish_top_of_book();
+            }
+        }
+    }
+    void publish_level(const PriceLevelQueue &level, bool is_buy);
+    void publish_update(LevelUpdateType type, bool is_buy, size_t level, PriceTicks price, uint64_t quantity);
+    void publish_top_of_book();
+};
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::BasicOrderBook(const OrderBookConfig& config)
+    : config_(config), price_(config.price_precision),
+      levels_(config, &level_pool_),
+      order_lookup_(config),
+      order_pool_(book_detail::pool_config(config)),
+      level_listener_(nullptr), feed_depth_(0),
+      top_of_book_(nullptr), levels_changed_(false), top_of_book_count_{0, 0}, top_of_book_worst_{0, 0},
+      journal_(nullptr), depth_enabled_(config.depth_index),
+      depth_{CumulativeDepth(false, depth_enabled_ ? config.ladder_capacity : 1, depth_enabled_ ? config.max_depth_window : 1),
+             CumulativeDepth(true, depth_enabled_ ? config.ladder_capacity : 1, depth_enabled_ ? config.max_depth_window : 1)},
+      last_level_(kNoLevel), last_level_is_buy_(false), owner_heads_(64), owned_orders_(0), batched_(0),
+      auction_(false) {
+    // Fixed policies override what the config asked for
+    config_.price_precision = price_.tick_size();
+    config_.level_storage = levels_.storage();
+    config_.order_index = order_lookup_.policy();
+    sink_.set_verbose(config_.verbose_logging);
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::update_config(const OrderBookConfig& new_config) {
+    // Resting levels are keyed in ticks of the original precision and live in the
+    // original storage, and resting orders live in the original index, so these stay fixed.
+    OrderBookConfig fixed = config_;
+    config_ = new_config;
+    config_.price_precision = fixed.price_precision;
+    config_.level_storage = fixed.level_storage;
+    config_.ladder_capacity = fixed.ladder_capacity;
+    config_.max_ladder_window = fixed.max_ladder_window;
+    config_.order_index = fixed.order_index;
+    config_.pool_huge_pages = fixed.pool_huge_pages;
+    config_.pool_prefault = fixed.pool_prefault;
+    config_.depth_index = fixed.depth_index;
+    config_.max_depth_window = fixed.max_depth_window;
+    sink_.set_verbose(config_.verbose_logging);
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::add_order(const Order &order) {
+    if (journal() != nullptr) {
+        journal()->append_add(order);
+    }
+    enter_order(order);
+    operation_done();
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+uint64_t BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::add_order(const Order &order, TimeInForce time_in_force) {
+    if (journal() != nullptr) {
+        journal()->append_add(order, time_in_force);
+    }
+    uint64_t filled = enter_order(order, time_in_force);
+    operation_done();
+    return filled;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+bool BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::cancel_order(uint64_t order_id) {
+    NodeIndex node_to_cancel = order_lookup_.find(order_id);
+    if (node_to_cancel == kNoNode) {
+        return false; // Order not found
+    }
+    cancel_resting_order(node_to_cancel);
+    operation_done();
+    return true;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+size_t BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::mass_cancel(const MassCancelRequest &request) {
+    // Only ticks inside [min_price, max_price] are in range; a NaN bound selects nothing
+    if (std::isnan(request.min_price) || std::isnan(request.max_price)) {
+        return 0;
+    }
+    PriceTicks low = range_bound(request.min_price, true);
+    PriceTicks high = range_bound(request.max_price, false);
+    if (low > high) {
+        return 0;
+    }
+    size_t cancelled = 0;
+
+    if (request.owner_id != 0) {
+        // Only the owner's own orders are visited
+        for (NodeIndex node = owner_heads_.find(request.owner_id); node != kNoNode;) {
+            const OrderNodeCold &cold = order_pool_.cold(node);
+            NodeIndex next = cold.owner_next;
+            if (cold.owner_next != kNoNode) {
+                __builtin_prefetch(&order_pool_.cold(cold.owner_next));
+            }
+            PriceTicks price = level_pool_.at(cold.level).price;
+            if ((cold.is_buy ? request.bids : request.asks) && price >= low && price <= high) {
+                const OrderNodeHot &hot = order_pool_.hot(node);
+                if (journal() != nullptr) {
+                    journal()->append_cancel(hot.order_id);
+                }
+                if (reporting()) {
+                    report_batched({ExecutionType::Cancelled, cold.is_buy, hot.order_id, 0,
+                                    price_.to_price(price), hot.quantity, 0, 0});
+                }
+                remove_resting_order(node);
+                ++cancelled;
+            }
+            node = next;
+        }
+        flush_reports();
+    } else {
+        // Every order in range goes, so whole levels are retired from the best edge of the range
+        for (bool is_buy : {true, false}) {
+            if (!(is_buy ? request.bids : request.asks)) {
+                continue;
+            }
+            PriceTicks edge = is_buy ? high : low;
+            PriceLevelQueue *level = levels_.best(is_buy);
+            if (level != nullptr && (is_buy ? level->price > edge : level->price < edge)) {
+                level = levels_.find(edge, is_buy);
+                level = level != nullptr ? level : levels_.next_worse(is_buy, edge);
+            }
+            while (level != nullptr && (is_buy ? level->price >= low : level->price <= high)) {
+                PriceTicks price = level->price;
+                cancelled += cancel_level(*level, is_buy);
+                remove_empty_price_level(price, is_buy);
+                level = levels_.next_worse(is_buy, price);
+            }
+        }
+    }
+
+    operation_done();
+    return cancelled;
+}
+
+// The first tick at or above price (round_up) or at or below it. Prices meant to sit on a tick
+// keep it despite floating-point noise; infinities and prices beyond the tick range map to its
+// ends. price must not be NaN.
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+PriceTicks BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::range_bound(double price, bool round_up) const {
+    if (std::isinf(price)) {
+        return price < 0 ? std::numeric_limits<PriceTicks>::min() : std::numeric_limits<PriceTicks>::max();
+    }
+    double ticks = price / price_.tick_size();
+    double slack = 1e-9 * std::max(1.0, std::fabs(ticks));
+    ticks = round_up ? std::ceil(ticks - slack) : std::floor(ticks + slack);
+    const double kTickRange = 9223372036854775808.0; // 2^63: outside it the cast is undefined
+    if (ticks >= kTickRange) {
+        return std::numeric_limits<PriceTicks>::max();
+    }
+    if (ticks < -kTickRange) {
+        return std::numeric_limits<PriceTicks>::min();
+    }
+    return static_cast<PriceTicks>(ticks);
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+bool BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::amend_order(uint64_t order_id, double new_price, uint64_t new_quantity) {
+    NodeIndex node = order_lookup_.find(order_id);
+    if (node == kNoNode) {
+        return false; // Order not found
+    }
+    amend_resting_order(node, new_price, new_quantity);
+    operation_done();
+    return true;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+size_t BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::apply_batch(const BookCommand *commands, size_t count, BookCommandResult *results) {
+    const size_t kSlotDistance = 8; // Index slot (and ladder level) prefetch
+    size_t accepted = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (i + kSlotDistance < count) {
+            prefetch_command(commands[i + kSlotDistance]);
+        }
+
+        const BookCommand &command = commands[i];
+        BookCommandResult result{command.order.order_id, true, 0, 0};
+        if (command.type == CommandType::Add) {
+            if (journal() != nullptr) {
+                journal()->append_add(command.order);
+            }
+            result.filled_quantity = enter_order(command.order);
+            result.resting_quantity = command.order.quantity - result.filled_quantity;
+        } else {
+            NodeIndex node = order_lookup_.find(command.order.order_id);
+            if (node == kNoNode) {
+                result.accepted = false;
+            } else if (command.type == CommandType::Cancel) {
+                cancel_resting_order(node);
+            } else {
+                result.resting_quantity = amend_resting_order(node, command.order.price, command.order.quantity);
+                result.filled_quantity = command.order.quantity - result.resting_quantity;
+            }
+        }
+        accepted += result.accepted;
+        if (results != nullptr) {
+            results[i] = result;
+        }
+    }
+
+    operation_done();
+    return accepted;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::prefetch_command(const BookCommand &command) const {
+    order_lookup_.prefetch(command.order.order_id);
+    if (levels_.can_prefetch() && command.type != CommandType::Cancel) {
+        levels_.prefetch(price_.to_ticks(command.order.price), command.order.is_buy);
+    }
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::cancel_resting_order(NodeIndex node) {
+    if (journal() != nullptr) {
+        journal()->append_cancel(order_pool_.hot(node).order_id);
+    }
+    if (reporting()) {
+        Order cancelled = resting_order(node);
+        report({ExecutionType::Cancelled, cancelled.is_buy, cancelled.order_id, 0,
+                cancelled.price, cancelled.quantity, 0, 0});
+    }
+    remove_resting_order(node);
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+uint64_t BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::amend_resting_order(NodeIndex node, double new_price, uint64_t new_quantity) {
+    OrderNodeHot &hot = order_pool_.hot(node);
+    OrderNodeCold &cold = order_pool_.cold(node);
+    uint64_t order_id = hot.order_id;
+    bool is_buy = cold.is_buy;
+    if (journal() != nullptr) {
+        journal()->append_amend(order_id, new_price, new_quantity);
+    }
+
+    // The node and its index entry stay put; only its place in the queues changes
+    PriceTicks new_ticks = price_.to_ticks(new_price);
+    PriceLevelQueue *price_level = &level_pool_.at(cold.level);
+    if (new_ticks == price_level->price) {
+        if (hot.quantity == new_quantity) {
+            return new_quantity;
+        }
+        bool loses_priority = new_quantity > hot.quantity && config_.amend_priority == AmendPriority::SizeUpLoses;
+        price_level->total_quantity -= hot.quantity;
+        price_level->total_quantity += new_quantity;
+        hot.quantity = new_quantity;
+        cold.original_quantity = new_quantity;
+        if (loses_priority) {
+            requeue_at_tail(node);
+        }
+        level_changed(*price_level, is_buy);
+
+        if (reporting()) {
+            report({ExecutionType::Amended, is_buy, order_id, 0,
+                    price_.to_price(price_level->price), new_quantity, 0, 0});
+        }
+        return new_quantity;
+    }
+
+    // A price change goes to the back of the new level, and trades first if it crosses
+    remove_order_from_price_level_queue(node);
+    if (price_level->total_quantity == 0) {
+        remove_empty_price_level(price_level->price, is_buy);
+    }
+    Order amended{order_id, is_buy, price_.to_price(new_ticks), new_quantity, cold.timestamp_ns};
+    if (reporting()) {
+        report({ExecutionType::Amended, is_buy, order_id, 0, amended.price, new_quantity, 0, 0});
+    }
+    if (!auction_ && crosses(is_buy, new_ticks)) {
+        match_aggressive_order(amended, new_ticks);
+    }
+    if (amended.quantity == 0) {
+        order_lookup_.erase(order_id);
+        cleanup_order_node(node);
+        return 0;
+    }
+
+    order_pool_.hot(node).quantity = amended.quantity;
+    order_pool_.cold(node).original_quantity = new_quantity;
+    add_order_to_price_level_queue(node, find_or_create_price_level(new_ticks, is_buy));
+    if (reporting()) {
+        report({ExecutionType::Rested, is_buy, order_id, 0, amended.price, amended.quantity, 0, 0});
+    }
+    return amended.quantity;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+bool BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::crosses(bool is_buy, PriceTicks limit) const {
+    if (is_buy) {
+        const PriceLevelQueue *best_ask = levels_.best(false);
+        return best_ask != nullptr && best_ask->price <= limit;
+    }
+    // A sell only trades with bids at its own price (see match_sell_order)
+    return levels_.find(limit, true) != nullptr;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::requeue_at_tail(NodeIndex node) {
+    // Relink within the level without touching its total
+    OrderNodeHot &hot = order_pool_.hot(node);
+    if (hot.next == kNoNode) {
+        return; // Already last
+    }
+    PriceLevelQueue &price_level = level_pool_.at(order_pool_.cold(node).level);
+    if (hot.prev != kNoNode) {
+        order_pool_.hot(hot.prev).next = hot.next;
+    }
+    else {
+        price_level.head = hot.next;
+    }
+    order_pool_.hot(hot.next).prev = hot.prev;
+    order_pool_.hot(price_level.tail).next = node;
+    hot.prev = price_level.tail;
+    hot.next = kNoNode;
+    price_level.tail = node;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+uint64_t BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::enter_order(const Order &order, TimeInForce time_in_force) {
+    // Convert to ticks once at the API boundary; the stored price is snapped to the tick grid
+    PriceTicks limit = price_.to_ticks(order.price);
+    Order remaining_order = order;
+    remaining_order.price = price_.to_price(limit);
+
+    // A FOK order that cannot fill completely never reaches the matching loops, and neither
+    // IOC nor FOK orders take part in an auction call
+    if ((time_in_force != TimeInForce::Day && auction_) ||
+        (time_in_force == TimeInForce::FOK && !fills_on_entry(remaining_order, limit))) {
+        if (reporting()) {
+            report({ExecutionType::Cancelled, order.is_buy, order.order_id, 0,
+                    remaining_order.price, order.quantity, 0, 0});
+        }
+        return 0;
+    }
+
+    // First, try to match the new order against existing orders
+    if (!auction_) {
+        match_aggressive_order(remaining_order, limit);
+    }
+
+    // The unfilled part of an IOC order is cancelled rather than rested
+    if (remaining_order.quantity > 0 && time_in_force != TimeInForce::Day) {
+        if (reporting()) {
+            report({ExecutionType::Cancelled, remaining_order.is_buy, remaining_order.order_id, 0,
+                    remaining_order.price, remaining_order.quantity, 0, 0});
+        }
+        return order.quantity - remaining_order.quantity;
+    }
+
+    // If there's remaining quantity, add it to the book
+    if (remaining_order.quantity > 0) {
+        NodeIndex node = create_order_node(remaining_order);
+        order_pool_.cold(node).original_quantity = order.quantity;
+
+        LevelIndex price_level = find_or_create_price_level(limit, remaining_order.is_buy);
+
+        add_order_to_price_level_queue(node, price_level);
+        order_lookup_.insert(remaining_order.order_id, node);
+        link_owner(node);
+
+        if (reporting()) {
+            report({ExecutionType::Rested, remaining_order.is_buy, remaining_order.order_id, 0,
+                    remaining_order.price, remaining_order.quantity, 0, 0});
+        }
+    }
+    return order.quantity - remaining_order.quantity;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+bool BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::fills_on_entry(const Order &order, PriceTicks limit) const {
+    if (order.is_buy) {
+        return depth_at_or_better_ticks(false, limit) >= order.quantity;
+    }
+    // A sell only trades with the head bid at its own price
+    const PriceLevelQueue *level = levels_.find(limit, true);
+    return level != nullptr && order_pool_.hot(level->head).quantity >= order.quantity;
+}
+
+// Pre-trade depth
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+uint64_t BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::depth_at_or_better_ticks(bool is_buy, PriceTicks price) const {
+    if (depth_enabled_) {
+        return depth_[is_buy].at_or_better(price);
+    }
+    uint64_t quantity = 0;
+    for (const PriceLevelQueue *level = levels_.best(is_buy);
+         level != nullptr && (is_buy ? level->price >= price : level->price <= price);
+         level = levels_.next_worse(is_buy, level->price)) {
+        quantity += level->total_quantity;
+    }
+    return quantity;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+uint64_t BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::depth_at_or_better(bool is_buy, double price) const {
+    return depth_at_or_better_ticks(is_buy, price_.to_ticks(price));
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+FillEstimate BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::estimate_fill(bool is_buy, uint64_t quantity, double limit) const {
+    FillEstimate estimate{0, 0.0, 0.0};
+    PriceTicks limit_ticks = price_.to_ticks(limit);
+    if (depth_enabled_) {
+        const CumulativeDepth &depth = depth_[!is_buy];
+        uint64_t available = depth.at_or_better(limit_ticks);
+        estimate.quantity = quantity < available ? quantity : available;
+        if (estimate.quantity > 0) {
+            PriceTicks worst = 0;
+            int64_t notional = 0;
+            depth.fill(estimate.quantity, worst, notional);
+            estimate.worst_price = price_.to_price(worst);
+            estimate.notional = price_.to_price(notional);
+        }
+        return estimate;
+    }
+    int64_t notional = 0;
+    for (const PriceLevelQueue *level = levels_.best(!is_buy);
+         level != nullptr && estimate.quantity < quantity &&
+         (is_buy ? level->price <= limit_ticks : level->price >= limit_ticks);
+         level = levels_.next_worse(!is_buy, level->price)) {
+        uint64_t take = std::min(quantity - estimate.quantity, level->total_quantity);
+        estimate.quantity += take;
+        notional += static_cast<int64_t>(take) * level->price;
+        estimate.worst_price = price_.to_price(level->price);
+    }
+    estimate.notional = price_.to_price(notional);
+    return estimate;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::remove_resting_order(NodeIndex node) {
+    PriceLevelQueue *price_level = &level_pool_.at(order_pool_.cold(node).level);
+    bool is_buy = order_pool_.cold(node).is_buy;
+
+    remove_order_from_price_level_queue(node);
+    order_lookup_.erase(order_pool_.hot(node).order_id);
+    cleanup_order_node(node);
+
+    // If the price level is now empty, remove it from the book
+    if (price_level->total_quantity == 0) {
+        remove_empty_price_level(price_level->price, is_buy);
+    }
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::get_snapshot(size_t depth, std::vector<PriceLevel> &bids, std::vector<PriceLevel> &asks) const {
+    bids.clear();
+    asks.clear();
+    bids.reserve(depth);
+    asks.reserve(depth);
+
+    levels_.for_each(true, depth, [&](const PriceLevelQueue &level) {
+        bids.push_back({price_.to_price(level.price), level.total_quantity});
+    });
+    levels_.for_each(false, depth, [&](const PriceLevelQueue &level) {
+        asks.push_back({price_.to_price(level.price), level.total_quantity});
+    });
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::print_book(size_t depth) const {
+    std::vector<PriceLevel> ask_levels, bid_levels;
+    get_snapshot(depth, bid_levels, ask_levels);
+    book_detail::print_book(bid_levels, ask_levels);
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+NodeIndex BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::create_order_node(const Order& order) {
+    NodeIndex node = order_pool_.allocate();
+    OrderNodeHot &hot = order_pool_.hot(node);
+    hot.order_id = order.order_id;
+    hot.quantity = order.quantity;
+    hot.next = kNoNode;
+    hot.prev = kNoNode;
+    OrderNodeCold &cold = order_pool_.cold(node);
+    cold.level = kNoLevel;
+    cold.timestamp_ns = order.timestamp_ns;
+    cold.original_quantity = order.quantity;
+    cold.owner_id = order.owner_id;
+    cold.owner_next = kNoNode;
+    cold.owner_prev = kNoNode;
+    cold.is_buy = order.is_buy;
+    return node;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::cleanup_order_node(NodeIndex node) {
+    if (owned_orders_ != 0) {
+        unlink_owner(node);
+    }
+    order_pool_.release(node);
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::link_owner(NodeIndex node) {
+    // Newest first, so linking never walks the list
+    OrderNodeCold &cold = order_pool_.cold(node);
+    if (cold.owner_id == 0) {
+        return;
+    }
+    NodeIndex head = owner_heads_.find(cold.owner_id);
+    cold.owner_next = head;
+    if (head != kNoNode) {
+        order_pool_.cold(head).owner_prev = node;
+    }
+    owner_heads_.insert(cold.owner_id, node);
+    ++owned_orders_;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::unlink_owner(NodeIndex node) {
+    OrderNodeCold &cold = order_pool_.cold(node);
+    if (cold.owner_id == 0) {
+        return;
+    }
+    if (cold.owner_prev != kNoNode) {
+        order_pool_.cold(cold.owner_prev).owner_next = cold.owner_next;
+    } else if (cold.owner_next != kNoNode) {
+        owner_heads_.insert(cold.owner_id, cold.owner_next);
+    } else {
+        owner_heads_.erase(cold.owner_id);
+    }
+    if (cold.owner_next != kNoNode) {
+        order_pool_.cold(cold.owner_next).owner_prev = cold.owner_prev;
+    }
+    cold.owner_id = 0;
+    --owned_orders_;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+Order BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::resting_order(NodeIndex node) const {
+    const OrderNodeHot &hot = order_pool_.hot(node);
+    const OrderNodeCold &cold = order_pool_.cold(node);
+    return {hot.order_id, cold.is_buy, price_.to_price(level_pool_.at(cold.level).price), hot.quantity,
+            cold.timestamp_ns, cold.owner_id};
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+bool BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::find_order(uint64_t order_id, Order &order) const {
+    NodeIndex node = order_lookup_.find(order_id);
+    if (node == kNoNode) {
+        return false;
+    }
+    order = resting_order(node);
+    return true;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::prefetch_queue_ahead(const OrderNodeHot &node) {
+    // Unlinking node loads its successor anyway, so start on the successor's own successor and
+    // index slot: a sweep then overlaps its cache misses instead of taking them one by one.
+    if (node.next != kNoNode) {
+        const OrderNodeHot &next = order_pool_.hot(node.next);
+        order_pool_.prefetch(next.next);
+        order_lookup_.prefetch(next.order_id);
+    }
+}
+
+// Price Level Management
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::add_order_to_price_level_queue(NodeIndex node, LevelIndex level) {
+    OrderNodeHot &hot = order_pool_.hot(node);
+    OrderNodeCold &cold = order_pool_.cold(node);
+    PriceLevelQueue &price_level = level_pool_.at(level);
+    cold.level = level;
+    hot.next = kNoNode;
+    hot.prev = price_level.tail;
+    if (price_level.head == kNoNode) {
+        // Price level is empty
+        price_level.head = node;
+    }
+    else {
+        // Append to tail for FIFO
+        order_pool_.hot(price_level.tail).next = node;
+    }
+    price_level.tail = node;
+    price_level.total_quantity += hot.quantity;
+    if (hot.quantity != 0) {
+        level_changed(price_level, cold.is_buy);
+    }
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::remove_order_from_price_level_queue(NodeIndex node) {
+    OrderNodeHot &hot = order_pool_.hot(node);
+    const OrderNodeCold &cold = order_pool_.cold(node);
+    PriceLevelQueue *price_level = &level_pool_.at(cold.level);
+    price_level->total_quantity -= hot.quantity;
+
+    if (hot.prev != kNoNode) {
+        order_pool_.hot(hot.prev).next = hot.next;
+    }
+    else {
+        price_level->head = hot.next;
+    }
+    if (hot.next != kNoNode) {
+        order_pool_.hot(hot.next).prev = hot.prev;
+    }
+    else {
+        price_level->tail = hot.prev;
+    }
+    if (hot.quantity != 0) {
+        level_changed(*price_level, cold.is_buy);
+    }
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+LevelIndex BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::find_or_create_price_level(PriceTicks price, bool is_buy) {
+    // Bursts of adds at one price skip the search. Removing any level clears the cache.
+    if (last_level_ != kNoLevel && last_level_is_buy_ == is_buy && level_pool_.at(last_level_).price == price) {
+        return last_level_;
+    }
+    last_level_ = levels_.find_or_create(price, is_buy);
+    last_level_is_buy_ = is_buy;
+    return last_level_;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::remove_empty_price_level(PriceTicks price, bool is_buy) {
+    last_level_ = kNoLevel;
+    levels_.remove(price, is_buy);
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::remove_best_price_level(bool is_buy) {
+    last_level_ = kNoLevel;
+    levels_.remove_best(is_buy);
+}
+
+// Matching Engine
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::match_aggressive_order(Order &order, PriceTicks limit) {
+    if (order.is_buy) {
+        match_buy_order(order, limit);
+    } else {
+        match_sell_order(order, limit);
+    }
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::match_buy_order(Order &order, PriceTicks limit) {
+    // For buy orders, match against asks (sell orders), best price first
+    while (order.quantity > 0) {
+        PriceLevelQueue *ask_level = levels_.best(false);
+
+        // Only match if the buy order price is >= ask price
+        if (ask_level == nullptr || limit < ask_level->price) {
+            break; // No more matching possible
+        }
+
+        // A level the order takes whole is retired in one pass
+        if (order.quantity >= ask_level->total_quantity) {
+            sweep_level(order, *ask_level, false);
+            remove_best_price_level(false);
+            continue;
+        }
+
+        NodeIndex ask_node = ask_level->head;
+        OrderNodeHot &ask = order_pool_.hot(ask_node);
+        uint64_t trade_quantity = std::min(order.quantity, ask.quantity);
+
+        order.quantity -= trade_quantity;
+        ask.quantity -= trade_quantity;
+        ask_level->total_quantity -= trade_quantity;
+
+        if (reporting()) {
+            report_trade(order, ask, ask_level->price, trade_quantity);
+        }
+
+        if (ask.quantity == 0) {
+            uint64_t id = ask.order_id;
+            prefetch_queue_ahead(ask);
+            remove_order_from_price_level_queue(ask_node);
+            order_lookup_.erase(id);
+            cleanup_order_node(ask_node);
+        }
+        level_changed(*ask_level, false);
+
+        if (ask_level->total_quantity == 0) {
+            remove_best_price_level(false);
+        }
+    }
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::match_sell_order(Order &order, PriceTicks limit) {
+    // For sell orders, match against bids (buy orders) from the sell price downwards.
+    // Bids below the sell price cannot match, and after one fill at a level the walk moves
+    // on to the next lower level, so only the head order at the sell price is eligible.
+    PriceLevelQueue *bid_level = levels_.find(limit, true);
+    if (bid_level == nullptr || order.quantity == 0) {
+        return; // No bids at the sell price
+    }
+
+    NodeIndex bid_node = bid_level->head;
+    OrderNodeHot &bid = order_pool_.hot(bid_node);
+    uint64_t trade_quantity = std::min(order.quantity, bid.quantity);
+
+    order.quantity -= trade_quantity;
+    bid.quantity -= trade_quantity;
+    bid_level->total_quantity -= trade_quantity;
+
+    if (reporting()) {
+        report_trade(order, bid, bid_level->price, trade_quantity);
+    }
+
+    if (bid.quantity == 0) {
+        uint64_t id = bid.order_id;
+        remove_order_from_price_level_queue(bid_node);
+        order_lookup_.erase(id);
+        cleanup_order_node(bid_node);
+    }
+    level_changed(*bid_level, true);
+
+    if (bid_level->total_quantity == 0) {
+        remove_empty_price_level(limit, true);
+    }
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::sweep_level(Order &order, PriceLevelQueue &level, bool is_buy) {
+    // Every resting order fills completely, so nothing is unlinked one at a time: one walk
+    // erases the index entries and builds the fills, then clear_level hands the queue back.
+    double price = price_.to_price(level.price);
+    size_t filled = 0;
+    for (NodeIndex node = level.head; node != kNoNode; node = order_pool_.hot(node).next) {
+        const OrderNodeHot &resting = order_pool_.hot(node);
+        prefetch_queue_ahead(resting);
+        order.quantity -= resting.quantity;
+        if (reporting()) {
+            report_batched({ExecutionType::Trade, order.is_buy, order.order_id, resting.order_id,
+                            price, resting.quantity, order.quantity, 0});
+        }
+        order_lookup_.erase(resting.order_id);
+        if (owned_orders_ != 0) {
+            unlink_owner(node);
+        }
+        ++filled;
+    }
+    flush_reports();
+    clear_level(level, is_buy, filled);
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+size_t BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::cancel_level(PriceLevelQueue &level, bool is_buy) {
+    double price = price_.to_price(level.price);
+    size_t cancelled = 0;
+    for (NodeIndex node = level.head; node != kNoNode; node = order_pool_.hot(node).next) {
+        const OrderNodeHot &resting = order_pool_.hot(node);
+        prefetch_queue_ahead(resting);
+        if (journal() != nullptr) {
+            journal()->append_cancel(resting.order_id);
+        }
+        if (reporting()) {
+            report_batched({ExecutionType::Cancelled, is_buy, resting.order_id, 0, price, resting.quantity, 0, 0});
+        }
+        order_lookup_.erase(resting.order_id);
+        if (owned_orders_ != 0) {
+            unlink_owner(node);
+        }
+        ++cancelled;
+    }
+    flush_reports();
+    clear_level(level, is_buy, cancelled);
+    return cancelled;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::clear_level(PriceLevelQueue &level, bool is_buy, size_t orders) {
+    // The queue goes back to the node pool as one list and the level changes once; the
+    // caller removes the empty level.
+    order_pool_.release_list(level.head, level.tail, orders);
+    level.head = kNoNode;
+    level.tail = kNoNode;
+    level.total_quantity = 0;
+    level_changed(level, is_buy);
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::begin_auction() {
+    if (journal() != nullptr) {
+        journal()->append_auction(JournalRecordType::BeginAuction);
+    }
+    auction_ = true;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+AuctionResult BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::uncross() {
+    if (journal() != nullptr) {
+        journal()->append_auction(JournalRecordType::Uncross);
+    }
+    AuctionResult result{false, 0.0, 0, 0};
+    PriceTicks price;
+    if (find_equilibrium(price, result.volume, result.imbalance)) {
+        result.crossed = true;
+        result.price = price_.to_price(price);
+        match_orders(price);
+    }
+    auction_ = false;
+    operation_done();
+    return result;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+AuctionResult BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::indicative_uncross() const {
+    AuctionResult result{false, 0.0, 0, 0};
+    PriceTicks price;
+    if (find_equilibrium(price, result.volume, result.imbalance)) {
+        result.crossed = true;
+        result.price = price_.to_price(price);
+    }
+    return result;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+bool BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::find_equilibrium(PriceTicks &price, uint64_t &volume, int64_t &imbalance) const {
+    const PriceLevelQueue *best_bid = levels_.best(true);
+    const PriceLevelQueue *best_ask = levels_.best(false);
+    if (best_bid == nullptr || best_ask == nullptr || best_bid->price < best_ask->price) {
+        return false;
+    }
+
+    // Only the crossed levels can trade: bids down to the best ask, asks up to the best bid
+    std::vector<AuctionLevel> &bids = auction_levels_[true];
+    std::vector<AuctionLevel> &asks = auction_levels_[false];
+    bids.clear();
+    asks.clear();
+    uint64_t demand = 0;
+    for (const PriceLevelQueue *level = best_bid; level != nullptr && level->price >= best_ask->price;
+         level = levels_.next_worse(true, level->price)) {
+        bids.push_back({level->price, level->total_quantity});
+        demand += level->total_quantity;
+    }
+    for (const PriceLevelQueue *level = best_ask; level != nullptr && level->price <= best_bid->price;
+         level = levels_.next_worse(false, level->price)) {
+        asks.push_back({level->price, level->total_quantity});
+    }
+
+    // Merge both sides in ascending price. At each level price p, demand is the bid quantity
+    // at p or above and supply the ask quantity at p or below; executable volume only changes
+    // at level prices, so they are the only candidates.
+    uint64_t supply = 0;
+    size_t ask = 0;
+    size_t bid = bids.size();
+    bool found = false;
+    uint64_t best_volume = 0;
+    uint64_t best_imbalance = 0;
+    PriceTicks low = 0, high = 0;                   // Range of prices tied on both
+    int64_t low_imbalance = 0, high_imbalance = 0;
+    while (ask < asks.size() || bid > 0) {
+        PriceTicks p = ask < asks.size() ? asks[ask].price : bids[bid - 1].price;
+        if (bid > 0 && bids[bid - 1].price < p) {
+            p = bids[bid - 1].price;
+        }
+        while (ask < asks.size() && asks[ask].price == p) {
+            supply += asks[ask++].quantity;
+        }
+
+        uint64_t executable = demand < supply ? demand : supply;
+        int64_t surplus = static_cast<int64_t>(demand - supply);
+        uint64_t magnitude = demand > supply ? demand - supply : supply - demand;
+        if (!found || executable > best_volume || (executable == best_volume && magnitude < best_imbalance)) {
+            found = true;
+            best_volume = executable;
+            best_imbalance = magnitude;
+            low = high = p;
+            low_imbalance = high_imbalance = surplus;
+        } else if (executable == best_volume && magnitude == best_imbalance) {
+            high = p;
+            high_imbalance = surplus;
+        }
+
+        while (bid > 0 && bids[bid - 1].price == p) {
+            demand -= bids[--bid].quantity;
+        }
+    }
+
+    // Buyers left over at every tied price push it up, sellers push it down
+    if (high_imbalance > 0) {
+        price = high;
+        imbalance = high_imbalance;
+    } else if (low_imbalance < 0) {
+        price = low;
+        imbalance = low_imbalance;
+    } else {
+        // Between two level prices; recount both sides there
+        price = low + (high - low) / 2;
+        demand = 0;
+        supply = 0;
+        for (const AuctionLevel &level : bids) {
+            demand += level.price >= price ? level.quantity : 0;
+        }
+        for (const AuctionLevel &level : asks) {
+            supply += level.price <= price ? level.quantity : 0;
+        }
+        imbalance = static_cast<int64_t>(demand - supply);
+    }
+    volume = best_volume;
+    return true;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::match_orders(PriceTicks price) {
+    // Uncross: every bid at or above price meets every ask at or below it, best levels first and
+    // FIFO within a level, and all of it trades at price
+    while (true) {
+        PriceLevelQueue *best_bid = levels_.best(true);
+        PriceLevelQueue *best_ask = levels_.best(false);
+        if (best_bid == nullptr || best_ask == nullptr || best_bid->price < price || best_ask->price > price) {
+            break;
+        }
+
+        PriceLevelQueue &best_bid_price_level = *best_bid;
+        PriceLevelQueue &best_ask_price_level = *best_ask;
+
+        NodeIndex bid_order_node = best_bid_price_level.head;
+        NodeIndex ask_order_node = best_ask_price_level.head;
+        OrderNodeHot &bid = order_pool_.hot(bid_order_node);
+        OrderNodeHot &ask = order_pool_.hot(ask_order_node);
+
+        uint64_t trade_quantity = std::min(bid.quantity, ask.quantity);
+
+        bid.quantity -= trade_quantity;
+        ask.quantity -= trade_quantity;
+
+        if (reporting()) {
+            // The bid is reported as the aggressor
+            report_trade(resting_order(bid_order_node), ask, price, trade_quantity);
+        }
+
+        best_bid_price_level.total_quantity -= trade_quantity;
+        best_ask_price_level.total_quantity -= trade_quantity;
+
+        if (bid.quantity == 0) {
+            uint64_t id = bid.order_id;
+            remove_order_from_price_level_queue(bid_order_node);
+            order_lookup_.erase(id);
+            cleanup_order_node(bid_order_node);
+        }
+
+        if (ask.quantity == 0) {
+            uint64_t id = ask.order_id;
+            remove_order_from_price_level_queue(ask_order_node);
+            order_lookup_.erase(id);
+            cleanup_order_node(ask_order_node);
+        }
+        level_changed(best_bid_price_level, true);
+        level_changed(best_ask_price_level, false);
+
+        if (best_bid_price_level.total_quantity == 0) {
+            remove_best_price_level(true);
+        }
+        if (best_ask_price_level.total_quantity == 0) {
+            remove_best_price_level(false);
+        }
+    }
+}
+
+// Market data
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::set_level_update_listener(LevelUpdateListener *listener, size_t depth) {
+    static_assert(EventSink::kEnabled, "market data needs an enabled event sink");
+    level_listener_ = listener;
+    feed_depth_ = depth;
+    for (bool is_buy : {true, false}) {
+        std::vector<PriceTicks> &top = top_levels_[is_buy];
+        top.clear();
+        if (listener == nullptr) {
+            continue;
+        }
+        top.reserve(depth + 1);
+        for (PriceLevelQueue *level = levels_.best(is_buy); level != nullptr && top.size() < depth;
+             level = levels_.next_worse(is_buy, level->price)) {
+            top.push_back(level->price);
+            publish_update(LevelUpdateType::New, is_buy, top.size() - 1, level->price, level->total_quantity);
+        }
+    }
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::publish_level(const PriceLevelQueue &level, bool is_buy) {
+    std::vector<PriceTicks> &top = top_levels_[is_buy];
+    PriceTicks price = level.price;
+
+    // Published levels are few, so a linear scan finds the position
+    size_t i = 0;
+    while (i < top.size() && (is_buy ? top[i] > price : top[i] < price)) {
+        ++i;
+    }
+
+    if (i < top.size() && top[i] == price) {
+        if (level.total_quantity != 0) {
+            publish_update(LevelUpdateType::Change, is_buy, i, price, level.total_quantity);
+            return;
+        }
+        // The emptied level may still be in storage, so refill from below the deepest published level
+        bool was_full = top.size() == feed_depth_;
+        PriceTicks deepest = top.back();
+        top.erase(top.begin() + i);
+        publish_update(LevelUpdateType::Delete, is_buy, i, price, 0);
+        if (was_full) {
+            const PriceLevelQueue *next = levels_.next_worse(is_buy, deepest);
+            if (next != nullptr) {
+                top.push_back(next->price);
+                publish_update(LevelUpdateType::New, is_buy, top.size() - 1, next->price, next->total_quantity);
+            }
+        }
+        return;
+    }
+
+    if (level.total_quantity == 0 || i == feed_depth_) {
+        return; // Below the published depth
+    }
+    // Every level better than the deepest published one is published, so this level is new
+    top.insert(top.begin() + i, price);
+    if (top.size() > feed_depth_) {
+        top.pop_back();
+    }
+    publish_update(LevelUpdateType::New, is_buy, i, price, level.total_quantity);
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::set_top_of_book(TopOfBook *top_of_book) {
+    static_assert(EventSink::kEnabled, "top of book publishing needs an enabled event sink");
+    top_of_book_ = top_of_book;
+    if (top_of_book_ != nullptr) {
+        publish_top_of_book();
+    }
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::publish_top_of_book() {
+    PriceLevel levels[2][TopOfBook::kMaxDepth];
+    for (bool is_buy : {true, false}) {
+        size_t &count = top_of_book_count_[is_buy];
+        count = 0;
+        levels_.for_each(is_buy, top_of_book_->depth(), [&](const PriceLevelQueue &level) {
+            levels[is_buy][count++] = {price_.to_price(level.price), level.total_quantity};
+            top_of_book_worst_[is_buy] = level.price;
+        });
+    }
+    top_of_book_->publish(levels[1], top_of_book_count_[1], levels[0], top_of_book_count_[0]);
+    levels_changed_ = false;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::publish_update(LevelUpdateType type, bool is_buy, size_t level, PriceTicks price, uint64_t quantity) {
+    level_listener_->on_level_update({type, is_buy, static_cast<uint32_t>(level), price_.to_price(price), quantity});
+}
+
+// Checkpoints
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+bool BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::save_checkpoint(const std::string &path) const {
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kCheckpointMagic, sizeof(kCheckpointMagic));
+    header.version = kCheckpointVersion;
+    header.verbose_logging = config_.verbose_logging;
+    header.level_storage = static_cast<uint8_t>(config_.level_storage);
+    header.order_index = static_cast<uint8_t>(config_.order_index);
+    header.depth_index = config_.depth_index;
+    header.amend_priority = static_cast<uint8_t>(config_.amend_priority);
+    header.auction = auction_;
+    header.default_snapshot_depth = config_.default_snapshot_depth;
+    header.price_precision = config_.price_precision;
+    header.ladder_capacity = config_.ladder_capacity;
+    header.expected_orders = config_.expected_orders;
+    header.slab_window_orders = config_.slab_window_orders;
+    header.max_ladder_window = config_.max_ladder_window;
+    header.max_depth_window = config_.max_depth_window;
+    header.journal_records = journal() != nullptr ? journal()->size() : 0;
+    header.bid_levels = levels_.level_count(true);
+    header.ask_levels = levels_.level_count(false);
+    header.order_count = order_lookup_.size();
+
+    // Stage records in a large buffer so the file is written in a few big chunks
+    std::vector<char> buffer;
+    buffer.reserve(size_t(1) << 20);
+    bool ok = true;
+    auto put = [&](const void *data, size_t bytes) {
+        if (buffer.size() + bytes > buffer.capacity()) {
+            ok = ok && std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+            buffer.clear();
+            buffer.reserve(bytes); // Oversized levels are staged whole
+        }
+        const char *bytes_ptr = static_cast<const char*>(data);
+        buffer.insert(buffer.end(), bytes_ptr, bytes_ptr + bytes);
+    };
+
+    put(&header, sizeof(header));
+    for (bool is_buy : {true, false}) {
+        std::vector<CheckpointOrder> level_orders;
+        levels_.for_each(is_buy, std::numeric_limits<size_t>::max(), [&](const PriceLevelQueue &level) {
+            // One walk of the queue: the node loads are the dominant cost
+            level_orders.clear();
+            for (NodeIndex node = level.head; node != kNoNode;) {
+                const OrderNodeHot &hot = order_pool_.hot(node);
+                order_pool_.prefetch(hot.next);
+                const OrderNodeCold &cold = order_pool_.cold(node);
+                level_orders.push_back({hot.order_id, hot.quantity, cold.timestamp_ns, cold.owner_id, 0});
+                node = hot.next;
+            }
+            CheckpointLevel level_record{level.price, level_orders.size()};
+            put(&level_record, sizeof(level_record));
+            put(level_orders.data(), level_orders.size() * sizeof(CheckpointOrder));
+        });
+    }
+    ok = ok && std::fwrite(buffer.data(), 1, buffer.size(), file) == buffer.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+bool BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::load_checkpoint(const std::string &path) {
+    std::vector<char> data;
+    CheckpointHeader header;
+    if (order_lookup_.size() != 0 || !book_detail::read_checkpoint_file(path, data, header, false) ||
+        header.price_precision != config_.price_precision) {
+        return false;
+    }
+
+    // Validate the layout before touching the book
+    size_t offset = sizeof(CheckpointHeader);
+    uint64_t orders = 0;
+    for (uint64_t i = 0; i < header.bid_levels + header.ask_levels; ++i) {
+        CheckpointLevel level;
+        if (data.size() - offset < sizeof(level)) {
+            return false;
+        }
+        std::memcpy(&level, data.data() + offset, sizeof(level));
+        offset += sizeof(level);
+        if (level.order_count == 0 || (data.size() - offset) / sizeof(CheckpointOrder) < level.order_count) {
+            return false;
+        }
+        offset += level.order_count * sizeof(CheckpointOrder);
+        orders += level.order_count;
+    }
+    if (offset != data.size() || orders != header.order_count) {
+        return false;
+    }
+
+    order_lookup_.reserve(header.order_count);
+    order_pool_.reserve(header.order_count);
+
+    // Link nodes straight onto the tail of each level, in their saved FIFO order
+    offset = sizeof(CheckpointHeader);
+    for (uint64_t i = 0; i < header.bid_levels + header.ask_levels; ++i) {
+        bool is_buy = i < header.bid_levels;
+        CheckpointLevel level_record;
+        std::memcpy(&level_record, data.data() + offset, sizeof(level_record));
+        offset += sizeof(level_record);
+
+        LevelIndex level_index = find_or_create_price_level(level_record.price, is_buy);
+        PriceLevelQueue *level = &level_pool_.at(level_index);
+        double price = price_.to_price(level_record.price);
+        const size_t kPrefetchDistance = 8;
+        for (uint64_t n = 0; n < level_record.order_count; ++n, offset += sizeof(CheckpointOrder)) {
+            CheckpointOrder order;
+            if (n + kPrefetchDistance < level_record.order_count) {
+                std::memcpy(&order, data.data() + offset + kPrefetchDistance * sizeof(CheckpointOrder), sizeof(order));
+                order_lookup_.prefetch(order.order_id);
+            }
+            std::memcpy(&order, data.data() + offset, sizeof(order));
+            if (order.quantity == 0 || order_lookup_.find(order.order_id) != kNoNode) {
+                discard_loaded_orders();
+                return false;
+            }
+            NodeIndex node = create_order_node({order.order_id, is_buy, price, order.quantity, order.timestamp_ns,
+                                                order.owner_id});
+            order_pool_.cold(node).level = level_index;
+            order_pool_.hot(node).prev = level->tail;
+            if (level->tail != kNoNode) {
+                order_pool_.hot(level->tail).next = node;
+            } else {
+                level->head = node;
+            }
+            level->tail = node;
+            level->total_quantity += order.quantity;
+            order_lookup_.insert(order.order_id, node);
+            link_owner(node);
+        }
+        if (depth_enabled_) {
+            depth_[is_buy].set(level->price, level->total_quantity);
+        }
+    }
+    update_config(book_detail::checkpoint_config(header));
+    auction_ = header.auction != 0;
+
+    // Bring market data consumers up to date
+    if constexpr (EventSink::kEnabled) {
+        if (level_listener_ != nullptr) {
+            set_level_update_listener(level_listener_, feed_depth_);
+        }
+        levels_changed_ = true;
+    }
+    operation_done();
+    return true;
+}
+
+// Undo a partial load_checkpoint: nodes and levels go back to their pools without reports,
+// journal records or market data, leaving the book empty as it was before the load.
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::discard_loaded_orders() {
+    for (bool is_buy : {true, false}) {
+        for (PriceLevelQueue *level = levels_.best(is_buy); level != nullptr; level = levels_.best(is_buy)) {
+            size_t orders = 0;
+            for (NodeIndex node = level->head; node != kNoNode; node = order_pool_.hot(node).next) {
+                ++orders;
+            }
+            if (orders > 0) {
+                order_pool_.release_list(level->head, level->tail, orders);
+            }
+            if (depth_enabled_) {
+                depth_[is_buy].set(level->price, 0);
+            }
+            levels_.remove_best(is_buy);
+        }
+    }
+    order_lookup_.clear();
+    owner_heads_.clear();
+    owned_orders_ = 0;
+}
+
+// Execution reporting
+template<typename PricePolicy, typename LevelContainer, typename IdIndex, typename EventSink>
+void BasicOrderBook<PricePolicy, LevelContainer, IdIndex, EventSink>::report_trade(const Order &aggressor, const OrderNodeHot &resting, PriceTicks price, uint64_t quantity) {
+    report({ExecutionType::Trade, aggressor.is_buy, aggressor.order_id, resting.order_id,
+            price_.to_price(price), quantity, aggressor.quantity, resting.quantity});
+}
+
+} // namespace OrderBookSystem
@@ -0,0 +1,348 @@
+#pragma once
+
+#include "order_book_config.h"
+#include "price_ticks.h"
+#include "price_level.h"
+#include "price_level_pool.h"
+#include "price_ladder.h"
+#include "order_index.h"
+#include "execution_report.h"
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <functional> // for std::greater
+#include <map>
+
+namespace OrderBookSystem {
+
+// Compile-time policies for BasicOrderBook. Each group below is one template parameter; the
+// Configured* variants choose at run time from OrderBookConfig and are what OrderBook uses.
+
+// --- Price representation: double API prices to and from PriceTicks ---
+
+// Tick size taken from OrderBookConfig::price_precision
+class RuntimeTickPrice {
+public:
+    explicit RuntimeTickPrice(double tick_size) : ticks_(tick_size) {}
+    PriceTicks to_ticks(double price) const { return ticks_.to_ticks(price); }
+    double to_price(PriceTicks ticks) const { return ticks_.to_price(ticks); }
+    double tick_size() const { return ticks_.tick_size(); }
+
+private:
+    TickConverter ticks_;
+};
+
+// Tick size fixed at compile time as 1 / TicksPerUnit; the configured precision is ignored.
+template<int64_t TicksPerUnit>
+class FixedTickPrice {
+public:
+    explicit FixedTickPrice(double) {}
+    PriceTicks to_ticks(double price) const {
+        return static_cast<PriceTicks>(std::llround(price * static_cast<double>(TicksPerUnit)));
+    }
+    double to_price(PriceTicks ticks) const {
+        return static_cast<double>(ticks) / static_cast<double>(TicksPerUnit);
+    }
+    double tick_size() const { return 1.0 / static_cast<double>(TicksPerUnit); }
+};
+
+// --- Level containers: both sides' price levels, ordered best first ---
+// Levels are allocated from the book's PriceLevelPool; containers only order their indices.
+
+// std::map per side, with tree nodes recycled by a MapNodePool
+class MapLevels {
+public:
+    MapLevels(const OrderBookConfig &, PriceLevelPool *pool)
+        : pool_(pool),
+          bids_(BidMap::key_compare(), BidMap::allocator_type(&nodes_)),
+          asks_(AskMap::key_compare(), AskMap::allocator_type(&nodes_)) {}
+
+    LevelStorage storage() const { return LevelStorage::Map; }
+    size_t level_count(bool is_buy) const { return is_buy ? bids_.size() : asks_.size(); }
+
+    PriceLevelQueue* best(bool is_buy) const {
+        if (is_buy) {
+            return bids_.empty() ? nullptr : &pool_->at(bids_.begin()->second);
+        }
+        return asks_.empty() ? nullptr : &pool_->at(asks_.begin()->second);
+    }
+
+    PriceLevelQueue* find(PriceTicks price, bool is_buy) const {
+        if (is_buy) {
+            auto it = bids_.find(price);
+            return it == bids_.end() ? nullptr : &pool_->at(it->second);
+        }
+        auto it = asks_.find(price);
+        return it == asks_.end() ? nullptr : &pool_->at(it->second);
+    }
+
+    LevelIndex find_or_create(PriceTicks price, bool is_buy) {
+        return is_buy ? find_or_create_in(bids_, price) : find_or_create_in(asks_, price);
+    }
+
+    // Release the (empty) level at price
+    void remove(PriceTicks price, bool is_buy) {
+        if (is_buy) {
+            auto it = bids_.find(price);
+            pool_->release(it->second);
+            bids_.erase(it);
+        } else {
+            auto it = asks_.find(price);
+            pool_->release(it->second);
+            asks_.erase(it);
+        }
+    }
+
+    void remove_best(bool is_buy) {
+        if (is_buy) {
+            pool_->release(bids_.begin()->second);
+            bids_.erase(bids_.begin());
+        } else {
+            pool_->release(asks_.begin()->second);
+            asks_.erase(asks_.begin());
+        }
+    }
+
+    // Next level strictly worse than price, or nullptr
+    PriceLevelQueue* next_worse(bool is_buy, PriceTicks price) const {
+        if (is_buy) {
+            auto it = bids_.upper_bound(price);
+            return it == bids_.end() ? nullptr : &pool_->at(it->second);
+        }
+        auto it = asks_.upper_bound(price);
+        return it == asks_.end() ? nullptr : &pool_->at(it->second);
+    }
+
+    // Visit up to depth levels of one side from best to worst
+    template<typename Fn>
+    void for_each(bool is_buy, size_t depth, Fn &&fn) const {
+        if (is_buy) {
+            visit(bids_, depth, fn);
+        } else {
+            visit(asks_, depth, fn);
+        }
+    }
+
+    // Whether prefetch() does anything, so callers can skip computing its argument
+    bool can_prefetch() const { return false; }
+    void prefetch(PriceTicks, bool) const {}
+
+private:
+    using LevelMapEntry = std::pair<const PriceTicks, LevelIndex>;
+    using BidMap = std::map<PriceTicks, LevelIndex, std::greater<PriceTicks>, MapNodeAllocator<LevelMapEntry>>;
+    using AskMap = std::map<PriceTicks, LevelIndex, std::less<PriceTicks>, MapNodeAllocator<LevelMapEntry>>;
+
+    template<typename Map>
+    LevelIndex find_or_create_in(Map &levels, PriceTicks price) {
+        auto it = levels.lower_bound(price);
+        if (it == levels.end() || it->first != price) {
+            it = levels.emplace_hint(it, price, pool_->allocate(price));
+        }
+        return it->second;
+    }
+
+    template<typename Map, typename Fn>
+    void visit(const Map &levels, size_t depth, Fn &fn) const {
+        auto it = levels.begin();
+        for (size_t i = 0; i < depth && it != levels.end(); ++i, ++it) {
+            fn(static_cast<const PriceLevelQueue&>(pool_->at(it->second)));
+        }
+    }
+
+    PriceLevelPool *pool_;
+    MapNodePool nodes_; // Before the maps, which return their nodes to it on destruction
+    BidMap bids_;
+    AskMap asks_;
+};
+
+// A PriceLadder per side
+class LadderLevels {
+public:
+    LadderLevels(const OrderBookConfig &config, PriceLevelPool *pool)
+        : LadderLevels(config.ladder_capacity, config.max_ladder_window, pool) {}
+    LadderLevels(size_t capacity, size_t max_window, PriceLevelPool *pool)
+        : bids_(true, capacity, max_window, pool), asks_(false, capacity, max_window, pool) {}
+
+    LevelStorage storage() const { return LevelStorage::Ladder; }
+    size_t level_count(bool is_buy) const { return side(is_buy).level_count(); }
+    PriceLevelQueue* best(bool is_buy) { return side(is_buy).best(); }
+    const PriceLevelQueue* best(bool is_buy) const { return side(is_buy).best(); }
+    PriceLevelQueue* find(PriceTicks price, bool is_buy) const { return side(is_buy).find(price); }
+
+    LevelIndex find_or_create(PriceTicks price, bool is_buy) {
+        LevelIndex level;
+        side(is_buy).find_or_create(price, level);
+        return level;
+    }
+
+    void remove(PriceTicks price, bool is_buy) { side(is_buy).remove(price); }
+    void remove_best(bool is_buy) { side(is_buy).remove(side(is_buy).best()->price); }
+    PriceLevelQueue* next_worse(bool is_buy, PriceTicks price) const { return side(is_buy).next_worse(price); }
+
+    template<typename Fn>
+    void for_each(bool is_buy, size_t depth, Fn &&fn) const { side(is_buy).for_each(depth, fn); }
+
+    bool can_prefetch() const { return true; }
+    void prefetch(PriceTicks price, bool is_buy) const { side(is_buy).prefetch(price); }
+
+private:
+    PriceLadder& side(bool is_buy) { return is_buy ? bids_ : asks_; }
+    const PriceLadder& side(bool is_buy) const { return is_buy ? bids_ : asks_; }
+
+    PriceLadder bids_;
+    PriceLadder asks_;
+};
+
+// Map or ladder, as OrderBookConfig::level_storage says
+class ConfiguredLevels {
+public:
+    ConfiguredLevels(const OrderBookConfig &config, PriceLevelPool *pool)
+        : use_ladder_(config.level_storage == LevelStorage::Ladder),
+          map_(config, pool), ladder_(use_ladder_ ? config.ladder_capacity : 1,
+                                       use_ladder_ ? config.max_ladder_window : 1, pool) {}
+
+    LevelStorage storage() const { return use_ladder_ ? LevelStorage::Ladder : LevelStorage::Map; }
+    size_t level_count(bool is_buy) const {
+        return use_ladder_ ? ladder_.level_count(is_buy) : map_.level_count(is_buy);
+    }
+    PriceLevelQueue* best(bool is_buy) { return use_ladder_ ? ladder_.best(is_buy) : map_.best(is_buy); }
+    const PriceLevelQueue* best(bool is_buy) const { return use_ladder_ ? ladder_.best(is_buy) : map_.best(is_buy); }
+    PriceLevelQueue* find(PriceTicks price, bool is_buy) const {
+        return use_ladder_ ? ladder_.find(price, is_buy) : map_.find(price, is_buy);
+    }
+    LevelIndex find_or_create(PriceTicks price, bool is_buy) {
+        return use_ladder_ ? ladder_.find_or_create(price, is_buy) : map_.find_or_create(price, is_buy);
+    }
+    void remove(PriceTicks price, bool is_buy) {
+        if (use_ladder_) {
+            ladder_.remove(price, is_buy);
+        } else {
+            map_.remove(price, is_buy);
+        }
+    }
+    void remove_best(bool is_buy) {
+        if (use_ladder_) {
+            ladder_.remove_best(is_buy);
+        } else {
+            map_.remove_best(is_buy);
+        }
+    }
+    PriceLevelQueue* next_worse(bool is_buy, PriceTicks price) const {
+        return use_ladder_ ? ladder_.next_worse(is_buy, price) : map_.next_worse(is_buy, price);
+    }
+    template<typename Fn>
+    void for_each(bool is_buy, size_t depth, Fn &&fn) const {
+        if (use_ladder_) {
+            ladder_.for_each(is_buy, depth, fn);
+        } else {
+            map_.for_each(is_buy, depth, fn);
+        }
+    }
+    bool can_prefetch() const { return use_ladder_; }
+    void prefetch(PriceTicks price, bool is_buy) const {
+        if (use_ladder_) {
+            ladder_.prefetch(price, is_buy);
+        }
+    }
+
+private:
+    bool use_ladder_;
+    MapLevels map_;
+    LadderLevels ladder_;
+};
+
+// --- Order ID indexes, constructed from the config ---
+
+class HashIdIndex : public OrderIdMap {
+public:
+    explicit HashIdIndex(const OrderBookConfig &config) : OrderIdMap(config.expected_orders) {}
+    OrderIndexPolicy policy() const { return OrderIndexPolicy::Hash; }
+};
+
+class SlabIdIndex : public OrderIdSlab {
+public:
+    explicit SlabIdIndex(const OrderBookConfig &config) : OrderIdSlab(config.slab_window_orders) {}
+    OrderIndexPolicy policy() const { return OrderIndexPolicy::Slab; }
+    void reserve(size_t) {} // Segments are allocated as IDs arrive
+};
+
+// Hash or slab, as OrderBookConfig::order_index says
+class ConfiguredIdIndex : public OrderIndex {
+public:
+    explicit ConfiguredIdIndex(const OrderBookConfig &config)
+        : OrderIndex(config.order_index, config.expected_orders, config.slab_window_orders) {}
+};
+
+// --- Event sinks: where execution reports go ---
+// kEnabled == false compiles out execution reports, market data publishing and journaling.
+
+// Prints a trade the way verbose logging does
+void print_trade_report(const ExecutionReport &report);
+
+// Reports nothing; the bare matching core
+class NullEventSink {
+public:
+    static constexpr bool kEnabled = false;
+    bool reporting() const { return false; }
+    void report(const ExecutionReport &) {}
+    void report_batch(const ExecutionReport *, size_t) {}
+    void set_verbose(bool) {}
+};
+
+// Reports to an optional ExecutionListener through its virtual interface, and prints trades
+// when verbose logging is on
+class ListenerEventSink {
+public:
+    static constexpr bool kEnabled = true;
+
+    bool reporting() const { return listener_ != nullptr || verbose_; }
+    void report(const ExecutionReport &report) {
+        if (listener_ != nullptr) {
+            listener_->on_execution(report);
+        }
+        if (verbose_ && report.type == ExecutionType::Trade) {
+            print_trade_report(report);
+        }
+    }
+    void report_batch(const ExecutionReport *reports, size_t count) {
+        if (listener_ != nullptr) {
+            listener_->on_executions(reports, count);
+        }
+        if (verbose_) {
+            for (size_t i = 0; i < count; ++i) {
+                if (reports[i].type == ExecutionType::Trade) {
+                    print_trade_report(reports[i]);
+                }
+            }
+        }
+    }
+    void set_verbose(bool enabled) { verbose_ = enabled; }
+    void set_listener(ExecutionListener *listener) { listener_ = listener; }
+
+private:
+    ExecutionListener *listener_ = nullptr;
+    bool verbose_ = false;
+};
+
+// Reports to one Handler through a direct, inlinable call to Handler::on_execution; verbose
+// logging is not supported. The handler must be attached before the first operation.
+template<typename Handler>
+class DirectEventSink {
+public:
+    static constexpr bool kEnabled = true;
+
+    bool reporting() const { return true; }
+    void report(const ExecutionReport &report) { handler_->Handler::on_execution(report); }
+    void report_batch(const ExecutionReport *reports, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            handler_->Handler::on_execution(reports[i]);
+        }
+    }
+    void set_verbose(bool) {}
+    void set_handler(Handler *handler) { handler_ = handler; }
+
+private:
+    Handler *handler_ = nullptr;
+};
+
+} // namespace OrderBookSystem
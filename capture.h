@@ -0,0 +1,516 @@
+#pragma once
+
+#include "common.h"
+#include "price_ticks.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace OrderBookSystem {
+
+// ITCH-style order-by-order market data. Every message starts with a 2-byte length (of the
+// whole message), a 1-byte type and an 8-byte timestamp; fields are little-endian and
+// unaligned, and prices are fixed point with 4 implied decimals.
+enum class CaptureMessageType : uint8_t {
+    Add = 'A',     // order_id, side ('B'/'S'), shares, price
+    Cancel = 'X',  // order_id, cancelled shares (partial cancel)
+    Delete = 'D',  // order_id
+    Replace = 'U', // original order_id, new order_id, shares, price; the new order loses priority
+    Execute = 'E'  // order_id, executed shares, match number
+};
+
+constexpr size_t kCaptureMessageHeaderSize = 11;
+constexpr size_t kCaptureAddSize = kCaptureMessageHeaderSize + 17;
+constexpr size_t kCaptureCancelSize = kCaptureMessageHeaderSize + 12;
+constexpr size_t kCaptureDeleteSize = kCaptureMessageHeaderSize + 8;
+constexpr size_t kCaptureReplaceSize = kCaptureMessageHeaderSize + 24;
+constexpr size_t kCaptureExecuteSize = kCaptureMessageHeaderSize + 20;
+constexpr double kCapturePriceScale = 10000.0;
+
+// First 32 bytes of a capture file
+struct CaptureHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    double tick_size;         // Tick of the instrument, for configuring the replay book
+    uint64_t message_count;   // Written on close; 0 if the writer did not finish
+};
+static_assert(sizeof(CaptureHeader) == 32, "CaptureHeader layout is part of the file format");
+
+constexpr char kCaptureMagic[8] = {'O', 'B', 'C', 'A', 'P', 'T', '\0', '\1'};
+constexpr uint32_t kCaptureVersion = 1;
+
+// One decoded message. order.order_id is the order the message applies to (the new order for
+// a replace, whose original is ref_order_id). For cancels and executes, order.quantity is the
+// number of shares removed and order.price is unset.
+struct CaptureEvent {
+    CaptureMessageType type;
+    uint64_t ref_order_id;
+    uint64_t match_number;
+    Order order;
+};
+
+// Buffered sequential writer of capture files
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter() { close(); }
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    bool open(const std::string &path, double tick_size) {
+        close();
+        file_ = std::fopen(path.c_str(), "wb");
+        if (file_ == nullptr) {
+            return false;
+        }
+        std::memset(&header_, 0, sizeof(header_));
+        std::memcpy(header_.magic, kCaptureMagic, sizeof(kCaptureMagic));
+        header_.version = kCaptureVersion;
+        header_.tick_size = tick_size;
+        buffer_.clear();
+        buffer_.reserve(kBufferBytes);
+        ok_ = std::fwrite(&header_, sizeof(header_), 1, file_) == 1;
+        return ok_;
+    }
+
+    // Writes the message count into the header; returns false if any write failed.
+    bool close() {
+        if (file_ == nullptr) {
+            return ok_;
+        }
+        flush_buffer();
+        ok_ = ok_ && std::fseek(file_, 0, SEEK_SET) == 0 &&
+              std::fwrite(&header_, sizeof(header_), 1, file_) == 1;
+        ok_ = (std::fclose(file_) == 0) && ok_;
+        file_ = nullptr;
+        return ok_;
+    }
+
+    void write_add(uint64_t timestamp_ns, uint64_t order_id, bool is_buy, uint32_t shares, uint32_t price) {
+        char *p = begin(kCaptureAddSize, CaptureMessageType::Add, timestamp_ns);
+        put(p, order_id);
+        p[8] = is_buy ? 'B' : 'S';
+        put(p + 9, shares);
+        put(p + 13, price);
+    }
+
+    void write_cancel(uint64_t timestamp_ns, uint64_t order_id, uint32_t cancelled_shares) {
+        char *p = begin(kCaptureCancelSize, CaptureMessageType::Cancel, timestamp_ns);
+        put(p, order_id);
+        put(p + 8, cancelled_shares);
+    }
+
+    void write_delete(uint64_t timestamp_ns, uint64_t order_id) {
+        char *p = begin(kCaptureDeleteSize, CaptureMessageType::Delete, timestamp_ns);
+        put(p, order_id);
+    }
+
+    void write_replace(uint64_t timestamp_ns, uint64_t order_id, uint64_t new_order_id,
+                       uint32_t shares, uint32_t price) {
+        char *p = begin(kCaptureReplaceSize, CaptureMessageType::Replace, timestamp_ns);
+        put(p, order_id);
+        put(p + 8, new_order_id);
+        put(p + 16, shares);
+        put(p + 20, price);
+    }
+
+    void write_execute(uint64_t timestamp_ns, uint64_t order_id, uint32_t executed_shares, uint64_t match_number) {
+        char *p = begin(kCaptureExecuteSize, CaptureMessageType::Execute, timestamp_ns);
+        put(p, order_id);
+        put(p + 8, executed_shares);
+        put(p + 12, match_number);
+    }
+
+    uint64_t message_count() const { return header_.message_count; }
+
+private:
+    static constexpr size_t kBufferBytes = size_t(1) << 20;
+
+    template<typename T>
+    static void put(char *p, T value) {
+        std::memcpy(p, &value, sizeof(value));
+    }
+
+    // Reserves size bytes in the buffer, fills in the common header, returns the body
+    char* begin(size_t size, CaptureMessageType type, uint64_t timestamp_ns) {
+        if (buffer_.size() + size > kBufferBytes) {
+            flush_buffer();
+        }
+        size_t offset = buffer_.size();
+        buffer_.resize(offset + size);
+        char *p = buffer_.data() + offset;
+        put(p, static_cast<uint16_t>(size));
+        p[2] = static_cast<char>(type);
+        put(p + 3, timestamp_ns);
+        ++header_.message_count;
+        return p + kCaptureMessageHeaderSize;
+    }
+
+    void flush_buffer() {
+        ok_ = ok_ && std::fwrite(buffer_.data(), 1, buffer_.size(), file_) == buffer_.size();
+        buffer_.clear();
+    }
+
+    std::FILE *file_ = nullptr;
+    CaptureHeader header_{};
+    std::vector<char> buffer_;
+    bool ok_ = false;
+};
+
+// Read-only mapping of a capture file. Messages are decoded straight out of the mapping, one
+// at a time, so replay never copies the file or allocates.
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    ~CaptureReader() { close(); }
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    bool open(const std::string &path) {
+        close();
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CaptureHeader))) {
+            close();
+            return false;
+        }
+        map_bytes_ = static_cast<size_t>(st.st_size);
+        void *map = ::mmap(nullptr, map_bytes_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (map == MAP_FAILED) {
+            close();
+            return false;
+        }
+        base_ = static_cast<const char*>(map);
+        ::madvise(const_cast<char*>(base_), map_bytes_, MADV_SEQUENTIAL);
+        if (std::memcmp(header().magic, kCaptureMagic, sizeof(kCaptureMagic)) != 0 ||
+            header().version != kCaptureVersion) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (base_ != nullptr) {
+            ::munmap(const_cast<char*>(base_), map_bytes_);
+            base_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    bool is_open() const { return base_ != nullptr; }
+    const CaptureHeader& header() const { return *reinterpret_cast<const CaptureHeader*>(base_); }
+
+    // Decode and visit every message in file order; stops early at a truncated or unknown
+    // message. Returns the number visited.
+    template<typename Fn>
+    size_t for_each(Fn &&fn) const {
+        const char *p = base_ + sizeof(CaptureHeader);
+        const char *end = base_ + map_bytes_;
+        size_t count = 0;
+        CaptureEvent event;
+        while (p + kCaptureMessageHeaderSize <= end) {
+            uint16_t size = get<uint16_t>(p);
+            if (p + size > end || !decode(p, size, event)) {
+                break;
+            }
+            fn(event);
+            p += size;
+            ++count;
+        }
+        return count;
+    }
+
+private:
+    template<typename T>
+    static T get(const char *p) {
+        T value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static bool decode(const char *p, uint16_t size, CaptureEvent &event) {
+        event.type = static_cast<CaptureMessageType>(p[2]);
+        event.order.timestamp_ns = get<uint64_t>(p + 3);
+        const char *body = p + kCaptureMessageHeaderSize;
+        switch (event.type) {
+            case CaptureMessageType::Add:
+                if (size != kCaptureAddSize) return false;
+                event.order.order_id = get<uint64_t>(body);
+                event.order.is_buy = body[8] == 'B';
+                event.order.quantity = get<uint32_t>(body + 9);
+                event.order.price = get<uint32_t>(body + 13) / kCapturePriceScale;
+                return true;
+            case CaptureMessageType::Cancel:
+                if (size != kCaptureCancelSize) return false;
+                event.order.order_id = get<uint64_t>(body);
+                event.order.quantity = get<uint32_t>(body + 8);
+                return true;
+            case CaptureMessageType::Delete:
+                if (size != kCaptureDeleteSize) return false;
+                event.order.order_id = get<uint64_t>(body);
+                return true;
+            case CaptureMessageType::Replace:
+                if (size != kCaptureReplaceSize) return false;
+                event.ref_order_id = get<uint64_t>(body);
+                event.order.order_id = get<uint64_t>(body + 8);
+                event.order.quantity = get<uint32_t>(body + 16);
+                event.order.price = get<uint32_t>(body + 20) / kCapturePriceScale;
+                return true;
+            case CaptureMessageType::Execute:
+                if (size != kCaptureExecuteSize) return false;
+                event.order.order_id = get<uint64_t>(body);
+                event.order.quantity = get<uint32_t>(body + 8);
+                event.match_number = get<uint64_t>(body + 12);
+                return true;
+        }
+        return false;
+    }
+
+    int fd_ = -1;
+    const char *base_ = nullptr;
+    size_t map_bytes_ = 0;
+};
+
+// Apply one message to any book with the OrderBook interface plus find_order. Cancels and
+// executes reduce the resting order in place (keeping its priority) and delete it once
+// nothing is left. Returns false if the message refers to an order the book does not have.
+template<typename Book>
+inline bool apply_capture_event(Book &book, const CaptureEvent &event) {
+    switch (event.type) {
+        case CaptureMessageType::Add:
+            book.add_order(event.order);
+            return true;
+        case CaptureMessageType::Delete:
+            return book.cancel_order(event.order.order_id);
+        case CaptureMessageType::Cancel:
+        case CaptureMessageType::Execute: {
+            Order resting;
+            if (!book.find_order(event.order.order_id, resting)) {
+                return false;
+            }
+            if (event.order.quantity >= resting.quantity) {
+                return book.cancel_order(event.order.order_id);
+            }
+            return book.amend_order(event.order.order_id, resting.price, resting.quantity - event.order.quantity);
+        }
+        case CaptureMessageType::Replace: {
+            Order resting;
+            if (!book.find_order(event.ref_order_id, resting)) {
+                return false;
+            }
+            Order replacement = event.order;
+            replacement.is_buy = resting.is_buy;
+            book.cancel_order(event.ref_order_id);
+            book.add_order(replacement);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Shape of a synthetic capture. Percentages are of messages; the rest are adds.
+struct CaptureGeneratorConfig {
+    uint64_t seed = 42;
+    double tick_size = 0.01;
+    double mid_price = 100.0;
+    double mean_touch_distance = 3.0; // Mean ticks behind the touch for new orders
+    int mid_move_pct = 1;
+    int delete_pct = 30;
+    int cancel_pct = 6;
+    int replace_pct = 10;
+    int execute_pct = 12;
+    uint32_t max_shares = 500;
+    double mean_gap_ns = 1000.0;      // Mean exchange time between messages
+};
+
+// Writes an exchange-consistent feed: the generator keeps its own FIFO book, adds and replaces
+// never cross it, and executes hit the head of the best level as an incoming aggressor would.
+// Replaying the file therefore reproduces the generator's book without the replay book
+// matching anything itself.
+class CaptureGenerator {
+public:
+    explicit CaptureGenerator(const CaptureGeneratorConfig &config)
+        : config_(config), rng_(config.seed), ticks_(config.tick_size),
+          mid_ticks_(ticks_.to_ticks(config.mid_price)), timestamp_ns_(0), next_order_id_(1), match_number_(1) {}
+
+    // Append num_messages messages to writer
+    void generate(CaptureWriter &writer, size_t num_messages) {
+        std::exponential_distribution<double> gap(1.0 / config_.mean_gap_ns);
+        for (size_t i = 0; i < num_messages; ++i) {
+            timestamp_ns_ += static_cast<uint64_t>(gap(rng_)) + 1;
+            if (percent() < config_.mid_move_pct) {
+                mid_ticks_ += (rng_() & 1) ? 1 : -1;
+            }
+            int op = percent();
+            if (live_.empty() || op >= config_.delete_pct + config_.cancel_pct + config_.replace_pct + config_.execute_pct) {
+                add(writer);
+            } else if (op < config_.delete_pct) {
+                uint64_t order_id = live_[pick_live()];
+                writer.write_delete(timestamp_ns_, order_id);
+                remove(order_id);
+            } else if (op < config_.delete_pct + config_.cancel_pct) {
+                uint64_t order_id = live_[pick_live()];
+                Resting &order = orders_[order_id];
+                if (order.shares == 1) {
+                    writer.write_delete(timestamp_ns_, order_id);
+                    remove(order_id);
+                } else {
+                    uint32_t cancelled = std::uniform_int_distribution<uint32_t>(1, order.shares - 1)(rng_);
+                    writer.write_cancel(timestamp_ns_, order_id, cancelled);
+                    order.shares -= cancelled;
+                }
+            } else if (op < config_.delete_pct + config_.cancel_pct + config_.replace_pct) {
+                uint64_t order_id = live_[pick_live()];
+                bool is_buy = orders_[order_id].is_buy;
+                remove(order_id);
+                uint64_t new_order_id = next_order_id_++;
+                uint32_t shares = next_shares();
+                PriceTicks price = passive_price(is_buy);
+                writer.write_replace(timestamp_ns_, order_id, new_order_id, shares, to_fixed(price));
+                insert(new_order_id, is_buy, price, shares);
+            } else {
+                execute(writer);
+            }
+        }
+    }
+
+    size_t live_orders() const { return live_.size(); }
+
+private:
+    struct Resting {
+        bool is_buy;
+        PriceTicks price;
+        uint32_t shares;
+        size_t live_index;
+    };
+
+    // Price levels hold order IDs in arrival order; removed IDs are skipped lazily at the head
+    struct Level {
+        std::deque<uint64_t> queue;
+        size_t live = 0;
+    };
+
+    int percent() {
+        return static_cast<int>(rng_() % 100);
+    }
+
+    uint32_t next_shares() {
+        return std::uniform_int_distribution<uint32_t>(1, config_.max_shares)(rng_);
+    }
+
+    size_t pick_live() {
+        return std::uniform_int_distribution<size_t>(0, live_.size() - 1)(rng_);
+    }
+
+    uint32_t to_fixed(PriceTicks price) const {
+        return static_cast<uint32_t>(ticks_.to_price(price) * kCapturePriceScale + 0.5);
+    }
+
+    // Behind the touch, and never through the other side
+    PriceTicks passive_price(bool is_buy) {
+        PriceTicks distance = std::geometric_distribution<int>(1.0 / (1.0 + config_.mean_touch_distance))(rng_);
+        std::map<PriceTicks, Level> &opposite = levels_[!is_buy];
+        if (is_buy) {
+            PriceTicks price = mid_ticks_ - 1 - distance;
+            if (!opposite.empty() && price >= opposite.begin()->first) {
+                price = opposite.begin()->first - 1;
+            }
+            return price > 1 ? price : 1;
+        }
+        PriceTicks price = mid_ticks_ + 1 + distance;
+        if (!opposite.empty() && price <= opposite.rbegin()->first) {
+            price = opposite.rbegin()->first + 1;
+        }
+        return price;
+    }
+
+    void add(CaptureWriter &writer) {
+        bool is_buy = (rng_() & 1) != 0;
+        uint64_t order_id = next_order_id_++;
+        uint32_t shares = next_shares();
+        PriceTicks price = passive_price(is_buy);
+        writer.write_add(timestamp_ns_, order_id, is_buy, shares, to_fixed(price));
+        insert(order_id, is_buy, price, shares);
+    }
+
+    // An aggressor takes part or all of the head order at the best level of one side
+    void execute(CaptureWriter &writer) {
+        bool is_buy = (rng_() & 1) != 0;
+        if (levels_[is_buy].empty()) {
+            is_buy = !is_buy;
+        }
+        std::map<PriceTicks, Level> &side = levels_[is_buy];
+        Level &best = is_buy ? side.rbegin()->second : side.begin()->second;
+        while (orders_.find(best.queue.front()) == orders_.end()) {
+            best.queue.pop_front();
+        }
+        uint64_t order_id = best.queue.front();
+        Resting &order = orders_[order_id];
+        uint32_t executed = percent() < 50 ? order.shares
+                                           : std::uniform_int_distribution<uint32_t>(1, order.shares)(rng_);
+        writer.write_execute(timestamp_ns_, order_id, executed, match_number_++);
+        order.shares -= executed;
+        if (order.shares == 0) {
+            remove(order_id);
+        }
+    }
+
+    void insert(uint64_t order_id, bool is_buy, PriceTicks price, uint32_t shares) {
+        orders_[order_id] = {is_buy, price, shares, live_.size()};
+        live_.push_back(order_id);
+        Level &level = levels_[is_buy][price];
+        level.queue.push_back(order_id);
+        ++level.live;
+    }
+
+    void remove(uint64_t order_id) {
+        auto it = orders_.find(order_id);
+        Resting order = it->second;
+        orders_.erase(it);
+        uint64_t last = live_.back();
+        live_[order.live_index] = last;
+        live_.pop_back();
+        if (last != order_id) {
+            orders_.find(last)->second.live_index = order.live_index;
+        }
+
+        auto level = levels_[order.is_buy].find(order.price);
+        if (--level->second.live == 0) {
+            levels_[order.is_buy].erase(level);
+        }
+    }
+
+    CaptureGeneratorConfig config_;
+    std::mt19937_64 rng_;
+    TickConverter ticks_;
+    PriceTicks mid_ticks_;
+    uint64_t timestamp_ns_;
+    uint64_t next_order_id_;
+    uint64_t match_number_;
+    std::unordered_map<uint64_t, Resting> orders_;
+    std::vector<uint64_t> live_;                // Resting order IDs, for picking one at random
+    std::map<PriceTicks, Level> levels_[2];     // [is_buy]
+};
+
+} // namespace OrderBookSystem
@@ -0,0 +1,171 @@
+#include "order_book.h"
+#include "capture.h"
+#include "thread_affinity.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+
+using namespace OrderBookSystem;
+
+// Replays an order-by-order capture file into OrderBook, either as fast as possible or paced
+// by the message timestamps. With --generate it first writes a synthetic capture, so the tool
+// also works without recorded data.
+
+struct Options {
+    std::string path = "orderbook_capture.bin";
+    size_t generate = 0;       // Messages to generate into path first; 0 replays an existing file
+    uint64_t seed = 42;
+    bool paced = false;        // Pace by message timestamps instead of replaying at full speed
+    double speed = 1.0;        // Paced only: 2.0 replays twice as fast as recorded
+    LevelStorage storage = LevelStorage::Map;
+    OrderIndexPolicy index = OrderIndexPolicy::Hash;
+    int cpu = -1;
+    bool keep = false;         // Keep a generated file afterwards
+};
+
+// Counts what the book reports; a consistent feed never makes the replay book trade
+class ReplayCounter : public ExecutionListener {
+public:
+    uint64_t trades = 0;
+    void on_execution(const ExecutionReport &report) override {
+        trades += (report.type == ExecutionType::Trade);
+    }
+};
+
+Options parse_options(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--path") {
+            options.path = value;
+        } else if (arg == "--generate") {
+            options.generate = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--pace") {
+            options.paced = std::strcmp(value, "timestamp") == 0;
+        } else if (arg == "--speed") {
+            options.speed = std::atof(value);
+        } else if (arg == "--storage") {
+            options.storage = std::strcmp(value, "ladder") == 0 ? LevelStorage::Ladder : LevelStorage::Map;
+        } else if (arg == "--index") {
+            options.index = std::strcmp(value, "slab") == 0 ? OrderIndexPolicy::Slab : OrderIndexPolicy::Hash;
+        } else if (arg == "--cpu") {
+            options.cpu = std::atoi(value);
+        } else if (arg == "--keep") {
+            options.keep = true;
+            continue;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--path FILE] [--generate N] [--seed N] [--keep]"
+                      << " [--pace max|timestamp] [--speed X] [--storage map|ladder] [--index hash|slab] [--cpu N]"
+                      << std::endl;
+            std::exit(1);
+        }
+        ++i;
+    }
+    if (options.speed <= 0.0) {
+        options.speed = 1.0;
+    }
+    return options;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv) {
+    Options options = parse_options(argc, argv);
+
+    if (options.generate > 0) {
+        CaptureGeneratorConfig generator_config;
+        generator_config.seed = options.seed;
+        CaptureWriter writer;
+        auto start = std::chrono::steady_clock::now();
+        if (!writer.open(options.path, generator_config.tick_size)) {
+            std::cerr << "Cannot create " << options.path << std::endl;
+            return 1;
+        }
+        CaptureGenerator(generator_config).generate(writer, options.generate);
+        if (!writer.close()) {
+            std::cerr << "Failed writing " << options.path << std::endl;
+            return 1;
+        }
+        std::cout << "Generated " << options.generate << " messages into " << options.path << " in "
+                  << std::fixed << std::setprecision(2) << seconds_since(start) << " s" << std::endl;
+    }
+
+    CaptureReader reader;
+    if (!reader.open(options.path)) {
+        std::cerr << "Cannot open capture " << options.path << std::endl;
+        return 1;
+    }
+    bool pinned = pin_current_thread(options.cpu);
+
+    OrderBookConfig config(false, 10, reader.header().tick_size);
+    config.level_storage = options.storage;
+    config.order_index = options.index;
+    OrderBook book(config);
+    ReplayCounter counter;
+    book.set_execution_listener(&counter);
+
+    // Touch the whole mapping first so page faults are not counted as replay time
+    uint64_t checksum = 0;
+    reader.for_each([&checksum](const CaptureEvent &event) { checksum += event.order.order_id; });
+
+    uint64_t type_counts[256] = {};
+    uint64_t rejected = 0;
+    uint64_t first_timestamp = 0;
+    bool have_first = false;
+    double max_lag_us = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    size_t messages = reader.for_each([&](const CaptureEvent &event) {
+        if (options.paced) {
+            if (!have_first) {
+                first_timestamp = event.order.timestamp_ns;
+                have_first = true;
+            }
+            auto due = start + std::chrono::nanoseconds(static_cast<int64_t>(
+                (event.order.timestamp_ns - first_timestamp) / options.speed));
+            auto now = std::chrono::steady_clock::now();
+            while (now < due) {
+                cpu_relax();
+                now = std::chrono::steady_clock::now();
+            }
+            double lag_us = std::chrono::duration<double, std::micro>(now - due).count();
+            max_lag_us = lag_us > max_lag_us ? lag_us : max_lag_us;
+        }
+        ++type_counts[static_cast<uint8_t>(event.type)];
+        rejected += !apply_capture_event(book, event);
+    });
+    double seconds = seconds_since(start);
+
+    std::cout << "--- Capture Replay (" << (options.paced ? "timestamp paced" : "max speed")
+              << ", " << (options.storage == LevelStorage::Map ? "map" : "ladder") << "/"
+              << (options.index == OrderIndexPolicy::Hash ? "hash" : "slab") << ", "
+              << (pinned ? "pinned" : "not pinned") << ") ---" << std::endl;
+    std::cout << "Messages:    " << messages;
+    if (reader.header().message_count != messages) {
+        std::cout << " (header says " << reader.header().message_count << ")";
+    }
+    std::cout << "\n  add " << type_counts['A'] << ", cancel " << type_counts['X'] << ", delete " << type_counts['D']
+              << ", replace " << type_counts['U'] << ", execute " << type_counts['E'] << std::endl;
+    std::cout << std::fixed << std::setprecision(3) << "Elapsed:     " << seconds << " s" << std::endl;
+    std::cout << std::setprecision(0) << "Throughput:  " << messages / seconds << " msgs/sec ("
+              << std::setprecision(1) << seconds * 1e9 / (messages ? messages : 1) << " ns/msg)" << std::endl;
+    if (options.paced) {
+        std::cout << "Max lag:     " << max_lag_us << " us behind schedule" << std::endl;
+    }
+    std::cout << "Final book:  " << book.order_count() << " orders, " << counter.trades << " trades, "
+              << rejected << " unknown-order messages (checksum " << checksum << ")" << std::endl;
+
+    reader.close();
+    if (options.generate > 0 && !options.keep) {
+        std::remove(options.path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace OrderBookSystem {
+
+// On-disk layout of an OrderBook checkpoint (native byte order):
+//   CheckpointHeader
+//   bid levels, best first, then ask levels, best first; each level is
+//     CheckpointLevel followed by order_count CheckpointOrders in FIFO order
+// Side and price are implied by the level, so each resting order costs 32 bytes.
+
+constexpr char kCheckpointMagic[8] = {'O', 'B', 'C', 'K', 'P', 'T', '\0', '\1'};
+constexpr uint32_t kCheckpointVersion = 4;
+
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint8_t verbose_logging;
+    uint8_t level_storage;      // LevelStorage
+    uint8_t order_index;        // OrderIndexPolicy
+    uint8_t depth_index;        // OrderBookConfig::depth_index
+    uint64_t default_snapshot_depth;
+    double price_precision;
+    uint64_t ladder_capacity;
+    uint64_t expected_orders;
+    uint64_t slab_window_orders;
+    uint64_t max_ladder_window;
+    uint64_t max_depth_window;
+    uint64_t journal_records;   // Journal length when the checkpoint was taken (0 if none attached)
+    uint64_t bid_levels;
+    uint64_t ask_levels;
+    uint64_t order_count;
+    uint8_t amend_priority;     // AmendPriority
+    uint8_t auction;            // 1 if taken during an auction call
+    uint8_t reserved[6];
+};
+static_assert(sizeof(CheckpointHeader) == 112, "CheckpointHeader layout is part of the file format");
+
+struct CheckpointLevel {
+    int64_t price;        // PriceTicks
+    uint64_t order_count;
+};
+
+struct CheckpointOrder {
+    uint64_t order_id;
+    uint64_t quantity;
+    uint64_t timestamp_ns;
+    uint32_t owner_id;
+    uint32_t reserved;
+};
+static_assert(sizeof(CheckpointOrder) == 32, "CheckpointOrder layout is part of the file format");
+
+} // namespace OrderBookSystem
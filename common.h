@@ -9,6 +9,7 @@ struct Order {
     double price;           // Limit price
     uint64_t quantity;      // Remaining quantity
     uint64_t timestamp_ns;  // Order entry timestamp in nanoseconds
+    uint32_t owner_id = 0;  // Participant or session, for mass cancels; 0 for none
 };
 
 struct PriceLevel {
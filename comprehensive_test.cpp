@@ -1,10 +1,25 @@
 #include "order_book.h"
+#include "workload.h"
+#include "sharded_engine.h"
+#include "journal.h"
+#include "capture.h"
 #include <iostream>
 #include <cassert>
 #include <vector>
 #include <chrono>
 #include <random>
 #include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <csignal>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 
 using namespace OrderBookSystem;
 
@@ -15,6 +30,18 @@ inline uint64_t get_nanos() {
     ).count();
 }
 
+// Level storage and order index under test; every test runs once per combination
+LevelStorage g_level_storage = LevelStorage::Map;
+OrderIndexPolicy g_order_index = OrderIndexPolicy::Hash;
+
+// Quiet configuration for the combination under test
+OrderBookConfig test_config(double precision = 0.01) {
+    OrderBookConfig config(false, 10, precision);
+    config.level_storage = g_level_storage;
+    config.order_index = g_order_index;
+    return config;
+}
+
 // Test helper to verify order book state
 void verify_order_book_state(OrderBook& book, const std::vector<PriceLevel>& expected_bids,
                            const std::vector<PriceLevel>& expected_asks, const std::string& test_name) {
@@ -59,8 +86,7 @@ void verify_order_book_state(OrderBook& book, const std::vector<PriceLevel>& exp
 void test_basic_order_operations() {
     std::cout << "\n=== Testing Basic Order Operations ===" << std::endl;
 
-    OrderBook book;
-    book.set_verbose(false);
+    OrderBook book(test_config());
     uint64_t id = 1;
 
     // Test 1: Add orders and verify state
@@ -112,8 +138,7 @@ void test_basic_order_operations() {
 void test_matching_engine() {
     std::cout << "\n=== Testing Matching Engine ===" << std::endl;
 
-    OrderBook book;
-    book.set_verbose(false);
+    OrderBook book(test_config());
     uint64_t id = 1;
 
     // Setup initial book
@@ -162,8 +187,7 @@ void test_matching_engine() {
 void test_fifo_ordering() {
     std::cout << "\n=== Testing FIFO Ordering ===" << std::endl;
 
-    OrderBook book;
-    book.set_verbose(false);
+    OrderBook book(test_config());
     uint64_t id = 1;
 
     // Add multiple orders at same price level
@@ -195,8 +219,8 @@ void test_fifo_ordering() {
 void test_edge_cases() {
     std::cout << "\n=== Testing Edge Cases ===" << std::endl;
 
-    OrderBook book;
-    book.set_verbose(false);
+    // Prices below are quoted to three decimals, so use a matching tick size
+    OrderBook book(test_config(0.001));
     uint64_t id = 1;
 
     // Test 1: Empty book
@@ -228,11 +252,1561 @@ void test_edge_cases() {
     std::cout << "✓ All edge case tests PASSED" << std::endl;
 }
 
+void test_tick_prices() {
+    std::cout << "\n=== Testing Tick Prices ===" << std::endl;
+
+    OrderBook book(test_config(0.01));
+    uint64_t id = 1;
+
+    // Computed prices that differ in the last bits must land on the same level
+    double computed_price = 100.0;
+    for (int i = 0; i < 3; ++i) {
+        computed_price += 0.1;
+    }
+    book.add_order({id++, true, 100.3, 10, get_nanos()});
+    book.add_order({id++, true, computed_price, 20, get_nanos()});
+    verify_order_book_state(book, {{100.3, 30}}, {}, "Computed prices share a level");
+
+    // Off-tick prices round to the nearest tick
+    book.add_order({id++, false, 100.304, 5, get_nanos()});
+    verify_order_book_state(book, {{100.3, 25}}, {}, "Off-tick price rounds to tick");
+
+    // Amending to an equivalent price keeps the order in place
+    book.add_order({id++, true, 99.9, 10, get_nanos()});
+    bool amend_result = book.amend_order(4, 99.90000000001, 15);
+    assert(amend_result == true);
+    verify_order_book_state(book, {{100.3, 25}, {99.9, 15}}, {}, "Amend at equivalent price");
+
+    std::cout << "✓ All tick price tests PASSED" << std::endl;
+}
+
+void test_ladder_recentering() {
+    std::cout << "\n=== Testing Ladder Re-centering ===" << std::endl;
+
+    // A small window forces the ladder to re-centre and grow
+    OrderBookConfig config = test_config();
+    config.ladder_capacity = 16;
+    OrderBook book(config);
+    uint64_t id = 1;
+
+    book.add_order({id++, true, 100.00, 10, get_nanos()});
+    book.add_order({id++, true, 100.00, 5, get_nanos()});
+    book.add_order({id++, false, 100.05, 20, get_nanos()});
+    book.add_order({id++, true, 50.00, 30, get_nanos()});    // Far below the window
+    book.add_order({id++, false, 150.00, 40, get_nanos()});  // Far above the window
+    verify_order_book_state(book,
+        {{100.00, 15}, {50.00, 30}},
+        {{100.05, 20}, {150.00, 40}},
+        "Orders outside the initial window");
+
+    // Orders moved by a re-centre must still cancel and fill correctly
+    assert(book.cancel_order(2));
+    book.add_order({id++, false, 50.00, 25, get_nanos()});
+    verify_order_book_state(book,
+        {{100.00, 10}, {50.00, 5}},
+        {{100.05, 20}, {150.00, 40}},
+        "Cancel and fill after re-centre");
+
+    book.add_order({id++, true, 200.00, 60, get_nanos()});
+    verify_order_book_state(book, {{100.00, 10}, {50.00, 5}}, {}, "Sweep every ask level");
+
+    // Once the side is empty the window follows the next order
+    book.add_order({id++, false, 1000.00, 7, get_nanos()});
+    verify_order_book_state(book, {{100.00, 10}, {50.00, 5}}, {{1000.00, 7}}, "Re-centre on far price");
+
+    // A capped window keeps far-away levels in its side map instead of growing to reach them
+    config.level_storage = LevelStorage::Ladder;
+    config.max_ladder_window = 64;
+    OrderBook capped(config);
+    capped.add_order({1, false, 100.00, 10, get_nanos()});
+    capped.add_order({2, false, 100.10, 10, get_nanos()});
+    capped.add_order({3, false, 1000000.00, 5, get_nanos()});   // 1e8 ticks away
+    capped.add_order({4, false, 100000000.00, 5, get_nanos()}); // 1e10 ticks away
+    capped.add_order({5, true, 99.90, 10, get_nanos()});
+    capped.add_order({6, true, 0.01, 10, get_nanos()});
+    verify_order_book_state(capped, {{99.90, 10}, {0.01, 10}},
+        {{100.00, 10}, {100.10, 10}, {1000000.00, 5}, {100000000.00, 5}}, "Levels beyond the capped window");
+
+    capped.add_order({7, true, 100.10, 20, get_nanos()});
+    verify_order_book_state(capped, {{99.90, 10}, {0.01, 10}},
+        {{1000000.00, 5}, {100000000.00, 5}}, "Best ask in the side map");
+    capped.add_order({8, false, 1000000.05, 3, get_nanos()}); // Re-centres over the level at 1e6
+    assert(capped.cancel_order(3));
+    verify_order_book_state(capped, {{99.90, 10}, {0.01, 10}},
+        {{1000000.05, 3}, {100000000.00, 5}}, "Side-map level adopted by a re-centre");
+    capped.add_order({9, true, 100000000.00, 8, get_nanos()});
+    assert(capped.cancel_order(5));
+    verify_order_book_state(capped, {{0.01, 10}}, {}, "Sweep and cancel across the side map");
+
+    std::cout << "✓ Ladder re-centering test PASSED" << std::endl;
+}
+
+void test_sparse_book_emptying() {
+    std::cout << "\n=== Testing Sparse Book Emptying ===" << std::endl;
+
+    OrderBook book(test_config());
+    const int num_levels = 200;
+    const double gap = 7.0;  // 700 ticks between levels, so neighbours sit in different bitmap words
+
+    for (int i = 0; i < num_levels; ++i) {
+        book.add_order({static_cast<uint64_t>(i + 1), true, 20000.0 - i * gap, 1, get_nanos()});
+    }
+
+    // Each cancel removes the best level; the next best must be found across the gap
+    std::vector<PriceLevel> bids, asks;
+    for (int i = 0; i < num_levels; ++i) {
+        book.get_snapshot(3, bids, asks);
+        assert(bids.size() == static_cast<size_t>(std::min(3, num_levels - i)));
+        assert(bids[0].price == 20000.0 - i * gap);
+        if (bids.size() > 1) {
+            assert(bids[1].price == 20000.0 - (i + 1) * gap);
+        }
+        assert(book.cancel_order(i + 1));
+    }
+    book.get_snapshot(3, bids, asks);
+    assert(bids.empty());
+
+    // Sweep a sparse ask side with a single aggressive buy
+    for (int i = 0; i < num_levels; ++i) {
+        book.add_order({static_cast<uint64_t>(1000 + i), false, 100.0 + i * gap, 2, get_nanos()});
+    }
+    book.add_order({5000, true, 100.0 + (num_levels - 1) * gap, 2 * num_levels - 1, get_nanos()});
+    verify_order_book_state(book, {}, {{100.0 + (num_levels - 1) * gap, 1}}, "Sparse sweep");
+
+    std::cout << "✓ Sparse book emptying test PASSED" << std::endl;
+}
+
+void test_level_pool() {
+    std::cout << "\n=== Testing Level Pool ===" << std::endl;
+
+    OrderBookConfig config = test_config();
+    config.ladder_capacity = 16;
+    OrderBook book(config);
+    uint64_t id = 1;
+    for (int level = 0; level < 10; ++level) {
+        book.add_order({id++, true, 99.00 - level * 0.01, 10, get_nanos()});
+        book.add_order({id++, false, 101.00 + level * 0.01, 10, get_nanos()});
+    }
+
+    // Levels opened and emptied inside the spread come back from the free list
+    MemoryPoolStats before = book.level_pool_stats();
+    assert(before.live == 20);
+    for (int round = 0; round < 10000; ++round) {
+        bool is_buy = (round & 1) != 0;
+        double price = is_buy ? 99.01 + (round % 50) * 0.01 : 100.99 - (round % 50) * 0.01;
+        book.add_order({id, is_buy, price, 5, get_nanos()});
+        assert(book.cancel_order(id++));
+    }
+    MemoryPoolStats after = book.level_pool_stats();
+    assert(after.live == 20 && after.peak == 21);
+    assert(after.capacity == before.capacity && after.chunks == before.chunks);
+
+    // A recycled level starts empty, and orders keep their level across a ladder re-centre
+    book.add_order({id++, true, 99.50, 7, get_nanos()});
+    book.add_order({id++, true, 99.50, 3, get_nanos()});
+    book.add_order({id++, true, 10.00, 1, get_nanos()}); // Forces the bid ladder to re-centre
+    Order resting;
+    assert(book.find_order(id - 2, resting) && resting.price == 99.50 && resting.quantity == 3);
+    assert(book.amend_order(id - 3, 99.50, 4));
+    std::vector<PriceLevel> bids, asks;
+    book.get_snapshot(1, bids, asks);
+    assert(bids.size() == 1 && bids[0].price == 99.50 && bids[0].total_quantity == 7);
+    assert(book.level_pool_stats().live == 22);
+
+    std::cout << "✓ Level pool test PASSED" << std::endl;
+}
+
+void test_order_id_window() {
+    std::cout << "\n=== Testing Order ID Window ===" << std::endl;
+
+    // A small slab window forces reclamation and overflow of old IDs
+    OrderBookConfig config = test_config();
+    config.slab_window_orders = 8192;
+    OrderBook book(config);
+
+    // A long-lived order far from the touch, then heavy churn of later IDs
+    book.add_order({1, true, 90.0, 7, get_nanos()});
+    for (uint64_t id = 2; id < 100000; ++id) {
+        book.add_order({id, false, 110.0, 1, get_nanos()});
+        if (id % 10 != 0) {
+            assert(book.cancel_order(id));
+        }
+    }
+
+    // Far jump in the ID sequence
+    const uint64_t far_id = uint64_t(1) << 50;
+    book.add_order({far_id, true, 95.0, 3, get_nanos()});
+    verify_order_book_state(book, {{95.0, 3}, {90.0, 7}}, {{110.0, 9999}}, "Churn and ID jump");
+
+    // Old, recent and far IDs all remain reachable
+    assert(book.amend_order(1, 90.0, 5));
+    assert(book.cancel_order(10));
+    assert(book.cancel_order(99990));
+    assert(book.cancel_order(far_id));
+    assert(!book.cancel_order(11));
+    verify_order_book_state(book, {{90.0, 5}}, {{110.0, 9997}}, "Lookups across the window");
+
+    std::cout << "✓ Order ID window test PASSED" << std::endl;
+}
+
+void test_execution_reports() {
+    std::cout << "\n=== Testing Execution Reports ===" << std::endl;
+
+    OrderBook book(test_config());
+    ExecutionReportBuffer reports(64);
+    book.set_execution_listener(&reports);
+
+    // Resting acks
+    book.add_order({1, false, 101.0, 10, get_nanos()});
+    book.add_order({2, false, 101.0, 5, get_nanos()});
+    assert(reports.size() == 2);
+    assert(reports[0].type == ExecutionType::Rested && reports[0].order_id == 1 && reports[0].quantity == 10);
+    assert(reports[1].type == ExecutionType::Rested && reports[1].order_id == 2 && !reports[1].is_buy);
+    reports.clear();
+
+    // One full and one partial fill of resting orders; nothing rests
+    book.add_order({3, true, 101.0, 12, get_nanos()});
+    assert(reports.size() == 2);
+    const ExecutionReport &full = reports[0];
+    assert(full.type == ExecutionType::Trade && full.is_buy);
+    assert(full.order_id == 3 && full.resting_order_id == 1);
+    assert(full.price == 101.0 && full.quantity == 10);
+    assert(full.leaves_quantity == 2 && full.resting_leaves_quantity == 0);
+    assert(full.is_partial_fill()); // Aggressor still has quantity left
+    const ExecutionReport &partial = reports[1];
+    assert(partial.resting_order_id == 2 && partial.quantity == 2);
+    assert(partial.leaves_quantity == 0 && partial.resting_leaves_quantity == 3);
+    assert(partial.is_partial_fill());
+    reports.clear();
+
+    // Cancel ack, and no report for an unknown order
+    assert(book.cancel_order(2));
+    assert(!book.cancel_order(2));
+    assert(reports.size() == 1);
+    assert(reports[0].type == ExecutionType::Cancelled && reports[0].order_id == 2 && reports[0].quantity == 3);
+    reports.clear();
+
+    // Amend in place, then amend to a new price which re-enters the order
+    book.add_order({4, false, 102.0, 10, get_nanos()});
+    assert(book.amend_order(4, 102.0, 4));
+    assert(book.amend_order(4, 103.0, 6));
+    assert(reports.size() == 4);
+    assert(reports[1].type == ExecutionType::Amended && reports[1].quantity == 4 && reports[1].price == 102.0);
+    assert(reports[2].type == ExecutionType::Amended && reports[2].quantity == 6 && reports[2].price == 103.0);
+    assert(reports[3].type == ExecutionType::Rested && reports[3].order_id == 4 && reports[3].price == 103.0);
+
+    ExecutionReport drained;
+    size_t drained_count = 0;
+    while (reports.pop(drained)) {
+        ++drained_count;
+    }
+    assert(drained_count == 4 && reports.empty());
+
+    // A full buffer drops and counts instead of allocating
+    ExecutionReportBuffer small(2);
+    book.set_execution_listener(&small);
+    book.add_order({5, true, 90.0, 1, get_nanos()});
+    book.add_order({6, true, 90.0, 1, get_nanos()});
+    book.add_order({7, true, 90.0, 1, get_nanos()});
+    assert(small.size() == 2 && small.dropped() == 1);
+
+    book.set_execution_listener(nullptr);
+    std::cout << "✓ Execution report test PASSED" << std::endl;
+}
+
+void test_batch_commands() {
+    std::cout << "\n=== Testing Batch Commands ===" << std::endl;
+
+    // Results for each kind of command
+    OrderBook book(test_config());
+    std::vector<BookCommand> commands = {
+        {CommandType::Add, {1, true, 100.0, 50, 1}},
+        {CommandType::Add, {2, true, 100.0, 30, 2}},   // Same level as order 1
+        {CommandType::Add, {3, false, 100.0, 60, 3}},  // Sells match only the head bid: 50 filled
+        {CommandType::Amend, {2, true, 99.0, 40, 4}},  // Moves price, loses priority
+        {CommandType::Amend, {2, true, 99.0, 10, 5}},  // Quantity only
+        {CommandType::Cancel, {7, true, 0.0, 0, 6}},   // Unknown
+        {CommandType::Cancel, {3, false, 0.0, 0, 7}},
+    };
+    std::vector<BookCommandResult> results(commands.size());
+    assert(book.apply_batch(commands.data(), commands.size(), results.data()) == 6);
+    assert(results[0].accepted && results[0].filled_quantity == 0 && results[0].resting_quantity == 50);
+    assert(results[2].order_id == 3 && results[2].filled_quantity == 50 && results[2].resting_quantity == 10);
+    assert(results[3].accepted && results[3].resting_quantity == 40);
+    assert(results[4].resting_quantity == 10 && results[4].filled_quantity == 0);
+    assert(!results[5].accepted && results[5].order_id == 7);
+    assert(results[6].accepted && results[6].resting_quantity == 0);
+    verify_order_book_state(book, {{99.0, 10}}, {}, "Batch command results");
+
+    // Batches of any size give the same book and reports as one command at a time
+    std::vector<WorkloadOp> ops = WorkloadGenerator(hft_workload(8)).generate(20000);
+    commands.clear();
+    for (const WorkloadOp &op : ops) {
+        CommandType type = op.type == OpType::Add ? CommandType::Add
+                         : op.type == OpType::Cancel ? CommandType::Cancel : CommandType::Amend;
+        commands.push_back({type, op.order});
+    }
+    OrderBook single(test_config());
+    OrderBook batched(test_config());
+    ExecutionReportBuffer single_reports(1 << 16), batched_reports(1 << 16);
+    single.set_execution_listener(&single_reports);
+    batched.set_execution_listener(&batched_reports);
+    size_t single_accepted = 0;
+    for (const WorkloadOp &op : ops) {
+        if (op.type == OpType::Add) {
+            single.add_order(op.order);
+            ++single_accepted;
+        } else if (op.type == OpType::Cancel) {
+            single_accepted += single.cancel_order(op.order.order_id);
+        } else {
+            single_accepted += single.amend_order(op.order.order_id, op.order.price, op.order.quantity);
+        }
+    }
+    size_t batched_accepted = 0;
+    for (size_t start = 0, size = 1; start < commands.size(); start += size, size = size % 37 + 1) {
+        size_t n = std::min(size, commands.size() - start);
+        batched_accepted += batched.apply_batch(commands.data() + start, n, nullptr);
+    }
+    assert(single_accepted == batched_accepted);
+    assert(single_reports.size() == batched_reports.size() && single_reports.dropped() == 0);
+    for (size_t i = 0; i < single_reports.size(); ++i) {
+        assert(single_reports[i].type == batched_reports[i].type);
+        assert(single_reports[i].order_id == batched_reports[i].order_id);
+        assert(single_reports[i].quantity == batched_reports[i].quantity);
+    }
+    std::vector<PriceLevel> single_bids, single_asks, batched_bids, batched_asks;
+    single.get_snapshot(100000, single_bids, single_asks);
+    batched.get_snapshot(100000, batched_bids, batched_asks);
+    assert(single_bids.size() == batched_bids.size() && single_asks.size() == batched_asks.size());
+    for (size_t i = 0; i < single_bids.size(); ++i) {
+        assert(single_bids[i].price == batched_bids[i].price && single_bids[i].total_quantity == batched_bids[i].total_quantity);
+    }
+    for (size_t i = 0; i < single_asks.size(); ++i) {
+        assert(single_asks[i].price == batched_asks[i].price && single_asks[i].total_quantity == batched_asks[i].total_quantity);
+    }
+    single.set_execution_listener(nullptr);
+    batched.set_execution_listener(nullptr);
+
+    std::cout << "✓ Batch commands test PASSED" << std::endl;
+}
+
+// Replay ops into a BasicOrderBook instantiation and check it ends up like reference
+template<typename Book>
+void check_policy_book(const std::vector<WorkloadOp> &ops, OrderBook &reference) {
+    Book book(test_config());
+    for (const WorkloadOp &op : ops) {
+        apply_op(book, op);
+    }
+    assert(book.order_count() == reference.order_count());
+    std::vector<PriceLevel> bids, asks, reference_bids, reference_asks;
+    book.get_snapshot(100000, bids, asks);
+    reference.get_snapshot(100000, reference_bids, reference_asks);
+    assert(bids.size() == reference_bids.size() && asks.size() == reference_asks.size());
+    for (size_t i = 0; i < bids.size(); ++i) {
+        assert(bids[i].price == reference_bids[i].price && bids[i].total_quantity == reference_bids[i].total_quantity);
+    }
+    for (size_t i = 0; i < asks.size(); ++i) {
+        assert(asks[i].price == reference_asks[i].price && asks[i].total_quantity == reference_asks[i].total_quantity);
+    }
+}
+
+void test_policy_books() {
+    std::cout << "\n=== Testing Policy Books ===" << std::endl;
+
+    // Every combination of fixed policies ends up in the same state as OrderBook
+    std::vector<WorkloadOp> ops = WorkloadGenerator(hft_workload(11)).generate(20000);
+    OrderBook reference(test_config());
+    ExecutionReportBuffer reference_reports(1 << 16);
+    reference.set_execution_listener(&reference_reports);
+    for (const WorkloadOp &op : ops) {
+        apply_op(reference, op);
+    }
+    check_policy_book<BasicOrderBook<FixedTickPrice<100>, MapLevels, HashIdIndex, NullEventSink>>(ops, reference);
+    check_policy_book<BasicOrderBook<FixedTickPrice<100>, MapLevels, SlabIdIndex, NullEventSink>>(ops, reference);
+    check_policy_book<BasicOrderBook<FixedTickPrice<100>, LadderLevels, HashIdIndex, NullEventSink>>(ops, reference);
+    check_policy_book<BasicOrderBook<FixedTickPrice<100>, LadderLevels, SlabIdIndex, NullEventSink>>(ops, reference);
+    check_policy_book<ConfiguredOrderBook>(ops, reference);
+
+    // A direct sink sees exactly the reports the listener does
+    BasicOrderBook<RuntimeTickPrice, LadderLevels, SlabIdIndex, DirectEventSink<ExecutionReportBuffer>> direct(test_config());
+    ExecutionReportBuffer direct_reports(1 << 16);
+    direct.event_sink().set_handler(&direct_reports);
+    for (const WorkloadOp &op : ops) {
+        apply_op(direct, op);
+    }
+    assert(direct_reports.size() == reference_reports.size() && direct_reports.dropped() == 0);
+    for (size_t i = 0; i < direct_reports.size(); ++i) {
+        assert(direct_reports[i].type == reference_reports[i].type);
+        assert(direct_reports[i].order_id == reference_reports[i].order_id);
+        assert(direct_reports[i].resting_order_id == reference_reports[i].resting_order_id);
+        assert(direct_reports[i].quantity == reference_reports[i].quantity);
+    }
+    reference.set_execution_listener(nullptr);
+
+    // Fixed policies override the config, which then describes the book as built
+    OrderBookConfig config = test_config(0.05);
+    config.level_storage = LevelStorage::Map;
+    config.order_index = OrderIndexPolicy::Hash;
+    BasicOrderBook<FixedTickPrice<4>, LadderLevels, SlabIdIndex, NullEventSink> fixed(config);
+    assert(fixed.get_config().price_precision == 0.25);
+    assert(fixed.get_config().level_storage == LevelStorage::Ladder);
+    assert(fixed.get_config().order_index == OrderIndexPolicy::Slab);
+    fixed.add_order({1, true, 100.3, 10, 1}); // Snaps to the 0.25 grid
+    fixed.add_order({2, false, 100.25, 4, 2});
+    Order resting;
+    assert(fixed.find_order(1, resting) && resting.price == 100.25 && resting.quantity == 6);
+    assert(!fixed.find_order(2, resting));
+
+    std::cout << "✓ Policy books test PASSED" << std::endl;
+}
+
+void test_time_in_force() {
+    std::cout << "\n=== Testing Time In Force and Cumulative Depth ===" << std::endl;
+
+    for (bool depth_index : {false, true}) {
+        OrderBookConfig config = test_config();
+        config.depth_index = depth_index;
+        OrderBook book(config);
+        ExecutionReportBuffer reports(64);
+        book.set_execution_listener(&reports);
+        book.add_order({1, false, 101.0, 10, 1});
+        book.add_order({2, false, 102.0, 20, 2});
+        book.add_order({3, false, 103.0, 30, 3});
+        book.add_order({4, true, 99.0, 5, 4});
+        book.add_order({5, true, 98.0, 15, 5});
+        reports.clear();
+
+        // Depth and cost to fill
+        assert(book.depth_at_or_better(false, 102.0) == 30);
+        assert(book.depth_at_or_better(false, 100.0) == 0);
+        assert(book.depth_at_or_better(false, 200.0) == 60);
+        assert(book.depth_at_or_better(true, 98.0) == 20);
+        assert(book.depth_at_or_better(true, 99.5) == 0);
+        FillEstimate estimate = book.estimate_fill(true, 25, 103.0);
+        assert(estimate.quantity == 25 && estimate.worst_price == 102.0);
+        assert(std::fabs(estimate.notional - (101.0 * 10 + 102.0 * 15)) < 1e-6);
+        estimate = book.estimate_fill(true, 100, 102.0);
+        assert(estimate.quantity == 30 && estimate.worst_price == 102.0);
+        estimate = book.estimate_fill(false, 10, 98.5);
+        assert(estimate.quantity == 5 && estimate.worst_price == 99.0);
+        estimate = book.estimate_fill(true, 10, 100.0);
+        assert(estimate.quantity == 0 && estimate.notional == 0.0);
+
+        // A FOK buy that cannot fill is killed without trading
+        assert(book.add_order({10, true, 102.0, 40, 10}, TimeInForce::FOK) == 0);
+        assert(reports.size() == 1 && reports[0].type == ExecutionType::Cancelled && reports[0].quantity == 40);
+        verify_order_book_state(book, {{99.0, 5}, {98.0, 15}}, {{101.0, 10}, {102.0, 20}, {103.0, 30}},
+                                "FOK kill leaves the book alone");
+        reports.clear();
+
+        // One that can fill sweeps two levels
+        assert(book.add_order({11, true, 102.0, 25, 11}, TimeInForce::FOK) == 25);
+        assert(reports.size() == 2 && reports[1].type == ExecutionType::Trade && reports[1].quantity == 15);
+        reports.clear();
+
+        // IOC fills what it can and the rest never rests
+        assert(book.add_order({12, true, 102.5, 50, 12}, TimeInForce::IOC) == 5);
+        assert(reports.size() == 2 && reports[1].type == ExecutionType::Cancelled && reports[1].quantity == 45);
+        Order resting;
+        assert(!book.find_order(12, resting));
+        assert(book.add_order({13, true, 100.0, 7, 13}, TimeInForce::IOC) == 0);
+        assert(!book.find_order(13, resting));
+
+        // A sell trades only with the head bid at its own price, and FOK follows that
+        assert(book.add_order({14, false, 99.0, 6, 14}, TimeInForce::FOK) == 0);
+        assert(book.add_order({15, false, 98.0, 10, 15}, TimeInForce::FOK) == 10);
+        verify_order_book_state(book, {{99.0, 5}, {98.0, 5}}, {{103.0, 30}}, "FOK and IOC results");
+        book.set_execution_listener(nullptr);
+    }
+
+    // The depth index agrees with a walk of the snapshot through churn, re-centring and a
+    // checkpoint round trip
+    OrderBookConfig config = test_config();
+    config.depth_index = true;
+    config.ladder_capacity = 64; // Small window, so it re-centres
+    OrderBook indexed(config);
+    std::vector<WorkloadOp> ops = WorkloadGenerator(uniform_workload(21)).generate(30000);
+    auto check = [](OrderBook &book) {
+        std::vector<PriceLevel> bids, asks;
+        book.get_snapshot(100000, bids, asks);
+        for (const std::vector<PriceLevel> *side : {&bids, &asks}) {
+            bool is_buy = side == &bids;
+            uint64_t cumulative = 0;
+            double notional = 0.0;
+            for (const PriceLevel &level : *side) {
+                cumulative += level.total_quantity;
+                notional += level.price * level.total_quantity;
+                assert(book.depth_at_or_better(is_buy, level.price) == cumulative);
+                FillEstimate estimate = book.estimate_fill(!is_buy, cumulative, is_buy ? 0.0 : 1e9);
+                assert(estimate.quantity == cumulative && estimate.worst_price == level.price);
+                assert(std::fabs(estimate.notional - notional) < 1e-6 * notional);
+            }
+        }
+    };
+    for (size_t i = 0; i < ops.size(); ++i) {
+        apply_op(indexed, ops[i]);
+        if (i % 5000 == 4999) {
+            check(indexed);
+        }
+    }
+    std::string path = "/tmp/comprehensive_test_" + std::to_string(::getpid()) + ".depth.checkpoint";
+    assert(indexed.save_checkpoint(path));
+    CheckpointInfo info;
+    assert(OrderBook::read_checkpoint_info(path, info) && info.config.depth_index);
+    OrderBook restored(info.config);
+    assert(restored.load_checkpoint(path));
+    std::remove(path.c_str());
+    check(restored);
+
+    // A capped window sums far-away levels, better and worse than it, from its side map
+    config.max_depth_window = 64;
+    config.ladder_capacity = 16;
+    OrderBook capped(config);
+    capped.add_order({1, false, 100.00, 10, 1});
+    capped.add_order({2, false, 100.05, 20, 2});
+    capped.add_order({3, false, 50.00, 5, 3});        // Better than the window
+    capped.add_order({4, false, 1000000.00, 40, 4});  // 1e8 ticks worse
+    capped.add_order({5, true, 49.00, 8, 5});
+    capped.add_order({6, true, 0.01, 9, 6});
+    check(capped);
+    assert(capped.depth_at_or_better(false, 100.00) == 15 && capped.depth_at_or_better(false, 2000000.0) == 75);
+    FillEstimate far_fill = capped.estimate_fill(true, 70, 1e9);
+    assert(far_fill.quantity == 70 && far_fill.worst_price == 1000000.00);
+    assert(std::fabs(far_fill.notional - (50.00 * 5 + 100.00 * 10 + 100.05 * 20 + 1000000.00 * 35)) < 1e-3);
+    assert(capped.add_order({7, true, 1000000.00, 76, 7}, TimeInForce::FOK) == 0);
+    assert(capped.add_order({8, true, 100.00, 15, 8}, TimeInForce::FOK) == 15);
+    assert(capped.cancel_order(2));
+    capped.add_order({9, false, 999999.90, 3, 9}); // Window now empty: re-centres over the level at 1e6
+    check(capped);
+    assert(capped.depth_at_or_better(false, 1000000.00) == 43);
+
+    // IOC and FOK adds replay from the journal as they ran
+    std::string journal_path = "/tmp/comprehensive_test_" + std::to_string(::getpid()) + ".tif.journal";
+    std::remove(journal_path.c_str());
+    OrderBook live(test_config());
+    {
+        JournalWriter journal;
+        assert(journal.open(journal_path, JournalConfig()));
+        live.set_journal(&journal);
+        live.add_order({1, false, 101.0, 10, 1});
+        live.add_order({2, true, 101.0, 15, 2}, TimeInForce::IOC);
+        live.add_order({3, false, 102.0, 10, 3});
+        live.add_order({4, true, 102.0, 20, 4}, TimeInForce::FOK);
+        live.add_order({5, true, 100.0, 20, 5});
+        live.set_journal(nullptr);
+    }
+    JournalReader reader;
+    assert(reader.open(journal_path));
+    OrderBook recovered(test_config());
+    reader.replay(recovered);
+    std::remove(journal_path.c_str());
+    verify_order_book_state(recovered, {{100.0, 20}}, {{102.0, 10}}, "Time in force journal replay");
+    assert(recovered.order_count() == live.order_count());
+
+    std::cout << "✓ Time in force test PASSED" << std::endl;
+}
+
+void test_level_sweeps() {
+    std::cout << "\n=== Testing Whole-Level Sweeps ===" << std::endl;
+
+    for (LevelStorage storage : {LevelStorage::Map, LevelStorage::Ladder}) {
+        OrderBookConfig config = test_config();
+        config.level_storage = storage;
+        config.depth_index = true;
+        OrderBook book(config);
+        ExecutionReportBuffer reports(1024);
+        book.set_execution_listener(&reports);
+        L2MirrorBook mirror(10);
+        book.set_level_update_listener(&mirror, 10);
+
+        // 20 levels of 1..40 orders; the level with 100 orders takes more than one fill batch
+        uint64_t id = 1;
+        uint64_t swept_quantity = 0;
+        for (int level = 0; level < 20; ++level) {
+            int orders = level == 3 ? 100 : 1 + level * 2;
+            for (int i = 0; i < orders; ++i) {
+                uint64_t quantity = 2 + (id % 5);
+                book.add_order({id++, false, 101.0 + level * 0.01, quantity, id});
+                if (level < 19) {
+                    swept_quantity += quantity;
+                }
+            }
+        }
+        book.add_order({id++, true, 99.0, 50, id});
+        size_t resting = book.order_count();
+        reports.clear();
+
+        // Takes 19 levels whole and part of the head order of the 20th
+        uint64_t aggressor = id++;
+        book.add_order({aggressor, true, 101.19, swept_quantity + 1, aggressor});
+        size_t trades = 0;
+        uint64_t filled = 0;
+        uint64_t leaves = swept_quantity + 1;
+        double price = 0.0;
+        uint64_t last_resting_id = 0;
+        for (size_t i = 0; i < reports.size(); ++i) {
+            const ExecutionReport &report = reports[i];
+            assert(report.type == ExecutionType::Trade && report.order_id == aggressor && report.is_buy);
+            assert(report.price >= price && report.resting_order_id > last_resting_id);
+            leaves -= report.quantity;
+            assert(report.leaves_quantity == leaves);
+            filled += report.quantity;
+            price = report.price;
+            last_resting_id = report.resting_order_id;
+            ++trades;
+        }
+        assert(reports.dropped() == 0 && leaves == 0 && filled == swept_quantity + 1);
+        assert(reports[reports.size() - 1].resting_leaves_quantity != 0);
+        assert(book.order_count() == resting - (trades - 1));
+        assert(book.memory_pool_stats().live == book.order_count());
+        assert(book.depth_at_or_better(false, 101.18) == 0);
+        std::vector<PriceLevel> bids, asks;
+        book.get_snapshot(10, bids, asks);
+        assert(mirror.bids().size() == bids.size() && mirror.asks().size() == asks.size());
+        for (size_t i = 0; i < asks.size(); ++i) {
+            assert(mirror.asks()[i].price == asks[i].price && mirror.asks()[i].total_quantity == asks[i].total_quantity);
+        }
+
+        // Swept nodes are reused
+        size_t capacity = book.memory_pool_stats().capacity;
+        for (size_t i = 0; i < trades; ++i) {
+            book.add_order({id++, false, 102.0, 1, id});
+        }
+        assert(book.memory_pool_stats().capacity == capacity);
+        assert(book.memory_pool_stats().live == book.order_count());
+
+        // A batch into a nearly full buffer keeps what fits and counts the rest
+        ExecutionReportBuffer small(4);
+        book.set_execution_listener(&small);
+        book.add_order({id++, true, 102.0, 1000, id});
+        assert(small.size() == 4 && small.dropped() > 0);
+        book.set_execution_listener(nullptr);
+        book.set_level_update_listener(nullptr, 0);
+    }
+
+    std::cout << "✓ Whole-level sweep test PASSED" << std::endl;
+}
+
+void test_amend_priority() {
+    std::cout << "\n=== Testing Amend Priority ===" << std::endl;
+
+    for (AmendPriority priority : {AmendPriority::SizeUpLoses, AmendPriority::Keep}) {
+        OrderBookConfig config = test_config();
+        config.amend_priority = priority;
+        OrderBook book(config);
+        ExecutionReportBuffer reports(64);
+        book.set_execution_listener(&reports);
+        book.add_order({1, false, 101.0, 10, 1});
+        book.add_order({2, false, 101.0, 10, 2});
+        book.add_order({3, false, 101.0, 10, 3});
+
+        // Size-down keeps priority under both policies; size-up loses it under SizeUpLoses
+        assert(book.amend_order(1, 101.0, 5));
+        assert(book.amend_order(2, 101.0, 20));
+        reports.clear();
+        book.add_order({10, true, 101.0, 6, 10});
+        assert(reports.size() == 2 && reports[0].resting_order_id == 1 && reports[0].quantity == 5);
+        uint64_t second = priority == AmendPriority::SizeUpLoses ? 3 : 2;
+        assert(reports[1].resting_order_id == second && reports[1].quantity == 1);
+        verify_order_book_state(book, {}, {{101.0, 29}}, "Amend at the same price");
+        book.set_execution_listener(nullptr);
+    }
+
+    // A price change relinks the existing node: no allocation, no change to the index
+    OrderBook book(test_config());
+    ExecutionReportBuffer reports(64);
+    book.set_execution_listener(&reports);
+    book.add_order({1, false, 101.0, 10, 1});
+    book.add_order({2, false, 102.0, 10, 2});
+    book.add_order({3, true, 99.0, 10, 3});
+    book.add_order({4, true, 99.0, 10, 4});
+    MemoryPoolStats before = book.memory_pool_stats();
+    assert(book.amend_order(3, 98.0, 15));
+    assert(book.amend_order(4, 97.0, 5));
+    MemoryPoolStats after = book.memory_pool_stats();
+    assert(after.live == before.live && after.peak == before.peak && book.order_count() == 4);
+    Order order;
+    assert(book.find_order(3, order) && order.price == 98.0 && order.quantity == 15 && order.timestamp_ns == 3);
+    verify_order_book_state(book, {{98.0, 15}, {97.0, 5}}, {{101.0, 10}, {102.0, 10}}, "Amend to a new price");
+    reports.clear();
+
+    // Crossing: trade first, then rest the remainder at the new price
+    assert(book.amend_order(3, 101.5, 15));
+    assert(reports.size() == 3);
+    assert(reports[0].type == ExecutionType::Amended && reports[0].price == 101.5);
+    assert(reports[1].type == ExecutionType::Trade && reports[1].order_id == 3 && reports[1].resting_order_id == 1);
+    assert(reports[2].type == ExecutionType::Rested && reports[2].quantity == 5);
+    verify_order_book_state(book, {{101.5, 5}, {97.0, 5}}, {{102.0, 10}}, "Crossing amend rests the rest");
+
+    // Filled completely: the order leaves the book
+    assert(book.amend_order(4, 102.0, 10));
+    assert(!book.find_order(4, order) && book.order_count() == 1);
+    assert(book.memory_pool_stats().live == 1);
+    verify_order_book_state(book, {{101.5, 5}}, {}, "Crossing amend fills");
+    book.set_execution_listener(nullptr);
+
+    // The policy survives a checkpoint, so journal replay after restore amends the same way
+    OrderBookConfig config = test_config();
+    config.amend_priority = AmendPriority::Keep;
+    OrderBook keep(config);
+    std::string path = "/tmp/comprehensive_test_" + std::to_string(::getpid()) + ".amend.checkpoint";
+    assert(keep.save_checkpoint(path));
+    CheckpointInfo info;
+    assert(OrderBook::read_checkpoint_info(path, info) && info.config.amend_priority == AmendPriority::Keep);
+    std::remove(path.c_str());
+
+    std::cout << "✓ Amend priority test PASSED" << std::endl;
+}
+
+void test_mass_cancel() {
+    std::cout << "\n=== Testing Mass Cancel ===" << std::endl;
+
+    for (LevelStorage storage : {LevelStorage::Map, LevelStorage::Ladder}) {
+        OrderBookConfig config = test_config();
+        config.level_storage = storage;
+        OrderBook book(config);
+        ExecutionReportBuffer reports(256);
+        book.set_execution_listener(&reports);
+        uint64_t id = 1;
+        for (int level = 0; level < 5; ++level) {
+            for (uint32_t owner = 0; owner < 4; ++owner) {
+                book.add_order({id++, true, 99.0 - level, 10, id, owner});
+                book.add_order({id++, false, 101.0 + level, 10, id, owner});
+            }
+        }
+        reports.clear();
+
+        // By owner: only that owner's orders, whatever their side and level
+        assert(book.mass_cancel({2, true, true}) == 10);
+        assert(reports.size() == 10 && book.order_count() == 30);
+        for (size_t i = 0; i < reports.size(); ++i) {
+            Order order;
+            assert(reports[i].type == ExecutionType::Cancelled && reports[i].quantity == 10);
+            assert(reports[i].order_id % 8 == 5 || reports[i].order_id % 8 == 6); // Owner 2's IDs
+            assert(!book.find_order(reports[i].order_id, order));
+        }
+        assert(book.mass_cancel({2, true, true}) == 0);
+
+        // By owner, side and price range
+        MassCancelRequest request;
+        request.owner_id = 1;
+        request.asks = false;
+        request.min_price = 96.5;
+        request.max_price = 98.0;
+        assert(book.mass_cancel(request) == 2);
+        verify_order_book_state(book, {{99.0, 30}, {98.0, 20}, {97.0, 20}, {96.0, 30}, {95.0, 30}},
+                                {{101.0, 30}, {102.0, 30}, {103.0, 30}, {104.0, 30}, {105.0, 30}},
+                                "Mass cancel by owner, side and range");
+
+        // Every owner in a range retires whole levels, and the owner lists follow
+        request = MassCancelRequest();
+        request.bids = false;
+        request.min_price = 102.0;
+        request.max_price = 103.5;
+        assert(book.mass_cancel(request) == 6);
+        assert(book.mass_cancel({1, true, true}) == 6); // 10, less 2 bids and 2 swept asks
+        verify_order_book_state(book, {{99.0, 20}, {98.0, 20}, {97.0, 20}, {96.0, 20}, {95.0, 20}},
+                                {{101.0, 20}, {104.0, 20}, {105.0, 20}}, "Mass cancel of a price range");
+
+        // Fills keep the owner lists consistent
+        book.add_order({id++, true, 101.0, 20, id});
+        assert(book.mass_cancel({3, false, true}) == 2); // Owner 3's ask at 101 was filled
+        reports.clear();
+
+        // Bounds off the tick grid take only the ticks inside them
+        request = MassCancelRequest();
+        request.min_price = 98.004;
+        request.max_price = 98.006;
+        assert(book.mass_cancel(request) == 0);
+        request.owner_id = 3;
+        assert(book.mass_cancel(request) == 0);
+        request = MassCancelRequest();
+        request.bids = false;
+        request.min_price = 103.995;
+        request.max_price = 104.999;
+        assert(book.mass_cancel(request) == 1);
+        request.min_price = std::nextafter(105.0, 106.0); // Floating-point noise around the 105.00 tick
+        request.max_price = std::nextafter(105.0, 104.0);
+        assert(book.mass_cancel(request) == 1);
+        verify_order_book_state(book, {{99.0, 20}, {98.0, 20}, {97.0, 20}, {96.0, 20}, {95.0, 20}}, {},
+                                "Mass cancel with bounds off the tick grid");
+
+        // NaN bounds select nothing; bounds beyond the tick range clamp to its ends
+        request = MassCancelRequest();
+        request.min_price = std::nan("");
+        assert(book.mass_cancel(request) == 0);
+        request = MassCancelRequest();
+        request.max_price = std::nan("");
+        request.owner_id = 3;
+        assert(book.mass_cancel(request) == 0);
+        request = MassCancelRequest();
+        request.min_price = 1e300;
+        assert(book.mass_cancel(request) == 0);
+        request.min_price = 98.5;
+        request.max_price = 1e300;
+        assert(book.mass_cancel(request) == 2); // Every order at 99.00
+        request.min_price = -1e300;
+        request.max_price = 95.0;
+        assert(book.mass_cancel(request) == 2);
+        verify_order_book_state(book, {{98.0, 20}, {97.0, 20}, {96.0, 20}}, {}, "Mass cancel with extreme bounds");
+        reports.clear();
+
+        // Everything
+        size_t resting = book.order_count();
+        assert(book.mass_cancel(MassCancelRequest()) == resting);
+        assert(reports.size() == resting && book.order_count() == 0);
+        assert(book.memory_pool_stats().live == 0);
+        verify_order_book_state(book, {}, {}, "Mass cancel of the whole book");
+        book.set_execution_listener(nullptr);
+    }
+
+    // Against a reference filter over a random workload with owners
+    std::vector<WorkloadOp> ops = WorkloadGenerator(uniform_workload(24)).generate(50000);
+    for (WorkloadOp &op : ops) {
+        op.order.owner_id = static_cast<uint32_t>(op.order.order_id % 7);
+    }
+    OrderBook book(test_config());
+    for (const WorkloadOp &op : ops) {
+        apply_op(book, op);
+    }
+    MassCancelRequest request;
+    request.owner_id = 3;
+    request.min_price = 99.5;
+    request.max_price = 100.5;
+    std::vector<uint64_t> expected, kept;
+    Order order;
+    for (const WorkloadOp &op : ops) {
+        if (op.type == OpType::Add && book.find_order(op.order.order_id, order)) {
+            bool selected = order.owner_id == 3 && order.price >= 99.5 && order.price <= 100.5;
+            (selected ? expected : kept).push_back(order.order_id);
+        }
+    }
+    assert(book.mass_cancel(request) == expected.size());
+    for (uint64_t order_id : expected) {
+        assert(!book.find_order(order_id, order));
+    }
+    for (uint64_t order_id : kept) {
+        assert(book.find_order(order_id, order));
+    }
+
+    // Owners survive a checkpoint and a journal replay
+    std::string path = "/tmp/comprehensive_test_" + std::to_string(::getpid()) + ".owner.checkpoint";
+    assert(book.save_checkpoint(path));
+    CheckpointInfo info;
+    assert(OrderBook::read_checkpoint_info(path, info));
+    OrderBook restored(info.config);
+    assert(restored.load_checkpoint(path));
+    std::remove(path.c_str());
+    size_t owner_five = book.mass_cancel({5, true, true});
+    assert(owner_five > 0 && restored.mass_cancel({5, true, true}) == owner_five);
+
+    std::string journal_path = "/tmp/comprehensive_test_" + std::to_string(::getpid()) + ".owner.journal";
+    std::remove(journal_path.c_str());
+    OrderBook live(test_config());
+    {
+        JournalWriter journal;
+        assert(journal.open(journal_path, JournalConfig()));
+        live.set_journal(&journal);
+        live.add_order({1, true, 99.0, 10, 1, 7});
+        live.add_order({2, true, 98.0, 10, 2, 8});
+        live.add_order({3, false, 101.0, 10, 3, 7});
+        assert(live.mass_cancel({7, false, true}) == 1);
+        live.set_journal(nullptr);
+    }
+    JournalReader reader;
+    assert(reader.open(journal_path));
+    OrderBook recovered(test_config());
+    reader.replay(recovered);
+    std::remove(journal_path.c_str());
+    verify_order_book_state(recovered, {{99.0, 10}, {98.0, 10}}, {}, "Mass cancel journal replay");
+    assert(recovered.mass_cancel({7, true, true}) == 1 && recovered.order_count() == 1);
+
+    std::cout << "✓ Mass cancel test PASSED" << std::endl;
+}
+
+void test_call_auction() {
+    std::cout << "\n=== Testing Call Auction ===" << std::endl;
+
+    for (LevelStorage storage : {LevelStorage::Map, LevelStorage::Ladder}) {
+        OrderBookConfig config = test_config();
+        config.level_storage = storage;
+        OrderBook book(config);
+        ExecutionReportBuffer reports(64);
+        book.set_execution_listener(&reports);
+
+        // Orders accumulate in a crossed book without trading
+        book.begin_auction();
+        assert(book.in_auction());
+        book.add_order({1, true, 102.0, 10, 1});
+        book.add_order({2, true, 101.0, 20, 2});
+        book.add_order({3, true, 100.0, 30, 3});
+        book.add_order({4, false, 99.0, 15, 4});
+        book.add_order({5, false, 100.0, 25, 5});
+        book.add_order({6, false, 101.0, 20, 6});
+        for (size_t i = 0; i < reports.size(); ++i) {
+            assert(reports[i].type == ExecutionType::Rested);
+        }
+        verify_order_book_state(book, {{102.0, 10}, {101.0, 20}, {100.0, 30}},
+                                {{99.0, 15}, {100.0, 25}, {101.0, 20}}, "Crossed book during the call");
+
+        // IOC and FOK orders are cancelled; crossing amends rest
+        assert(book.add_order({7, true, 105.0, 5, 7}, TimeInForce::IOC) == 0);
+        Order order;
+        assert(!book.find_order(7, order));
+        book.add_order({8, true, 98.0, 5, 8});
+        assert(book.amend_order(8, 103.0, 5) && book.find_order(8, order) && order.price == 103.0);
+        assert(book.cancel_order(8));
+        reports.clear();
+
+        // Most volume at 100: 40 traded, 20 buyers left over
+        AuctionResult indicative = book.indicative_uncross();
+        assert(indicative.crossed && indicative.price == 100.0 && indicative.volume == 40 && indicative.imbalance == 20);
+        AuctionResult result = book.uncross();
+        assert(result.crossed && result.price == indicative.price && result.volume == 40);
+        assert(!book.in_auction());
+        uint64_t traded = 0;
+        for (size_t i = 0; i < reports.size(); ++i) {
+            assert(reports[i].type == ExecutionType::Trade && reports[i].price == 100.0 && reports[i].is_buy);
+            traded += reports[i].quantity;
+        }
+        assert(traded == 40);
+        assert(reports[0].order_id == 1 && reports[0].resting_order_id == 4); // Best bid meets best ask first
+        verify_order_book_state(book, {{100.0, 20}}, {{101.0, 20}}, "After the uncross");
+
+        // Continuous matching resumes
+        book.add_order({9, true, 101.0, 5, 9});
+        verify_order_book_state(book, {{100.0, 20}}, {{101.0, 15}}, "Continuous after the uncross");
+        book.set_execution_listener(nullptr);
+    }
+
+    // Tie-breaks: surplus buyers take the highest price, surplus sellers the lowest, and a
+    // balanced range its middle
+    auto auction_price = [](uint64_t bid_quantity, uint64_t ask_quantity) {
+        OrderBook book(test_config());
+        book.begin_auction();
+        book.add_order({1, true, 101.0, bid_quantity, 1});
+        book.add_order({2, false, 99.0, ask_quantity, 2});
+        return book.uncross();
+    };
+    assert(auction_price(20, 10).price == 101.0 && auction_price(20, 10).imbalance == 10);
+    assert(auction_price(10, 20).price == 99.0 && auction_price(10, 20).imbalance == -10);
+    assert(auction_price(10, 10).price == 100.0 && auction_price(10, 10).volume == 10);
+
+    // Nothing crossed: nothing trades, and the call still ends
+    OrderBook quiet(test_config());
+    quiet.begin_auction();
+    quiet.add_order({1, true, 99.0, 10, 1});
+    quiet.add_order({2, false, 101.0, 10, 2});
+    assert(!quiet.indicative_uncross().crossed);
+    assert(!quiet.uncross().crossed && !quiet.in_auction() && quiet.order_count() == 2);
+
+    // Against a brute-force search over every tick of random crossed books
+    for (uint64_t seed = 1; seed <= 20; ++seed) {
+        WorkloadConfig workload = uniform_workload(seed);
+        workload.min_price = 99.0;
+        workload.max_price = 101.0;
+        std::vector<WorkloadOp> ops = WorkloadGenerator(workload).generate(2000);
+        OrderBook book(test_config());
+        book.begin_auction();
+        for (const WorkloadOp &op : ops) {
+            apply_op(book, op);
+        }
+        std::vector<PriceLevel> bids, asks;
+        book.get_snapshot(100000, bids, asks);
+        uint64_t best_volume = 0;
+        for (int tick = 9900; tick <= 10100; ++tick) {
+            double price = tick / 100.0;
+            uint64_t demand = 0, supply = 0;
+            for (const PriceLevel &level : bids) {
+                demand += level.price >= price - 1e-9 ? level.total_quantity : 0;
+            }
+            for (const PriceLevel &level : asks) {
+                supply += level.price <= price + 1e-9 ? level.total_quantity : 0;
+            }
+            best_volume = std::max(best_volume, std::min(demand, supply));
+        }
+
+        ExecutionReportBuffer reports(1 << 16);
+        book.set_execution_listener(&reports);
+        AuctionResult result = book.uncross();
+        assert(result.volume == best_volume && (best_volume == 0 || result.crossed));
+        uint64_t traded = 0;
+        for (size_t i = 0; i < reports.size(); ++i) {
+            assert(reports[i].price == result.price);
+            traded += reports[i].quantity;
+        }
+        assert(traded == result.volume);
+        book.get_snapshot(1, bids, asks);
+        assert(bids.empty() || asks.empty() || bids[0].price < asks[0].price);
+        book.set_execution_listener(nullptr);
+    }
+
+    // The call survives a checkpoint, and phase changes replay from the journal
+    std::string journal_path = "/tmp/comprehensive_test_" + std::to_string(::getpid()) + ".auction.journal";
+    std::string path = "/tmp/comprehensive_test_" + std::to_string(::getpid()) + ".auction.checkpoint";
+    std::remove(journal_path.c_str());
+    OrderBook live(test_config());
+    {
+        JournalWriter journal;
+        assert(journal.open(journal_path, JournalConfig()));
+        live.set_journal(&journal);
+        live.begin_auction();
+        live.add_order({1, true, 101.0, 10, 1});
+        live.add_order({2, false, 100.0, 4, 2});
+        assert(live.save_checkpoint(path));
+        live.add_order({3, false, 99.0, 4, 3});
+        live.uncross();
+        live.add_order({4, false, 101.0, 1, 4});
+        live.set_journal(nullptr);
+    }
+    CheckpointInfo info;
+    assert(OrderBook::read_checkpoint_info(path, info));
+    OrderBook restored(info.config);
+    assert(restored.load_checkpoint(path) && restored.in_auction());
+    std::remove(path.c_str());
+    JournalReader reader;
+    assert(reader.open(journal_path));
+    OrderBook recovered(test_config());
+    reader.replay(recovered);
+    reader.replay(restored, info.journal_records);
+    std::remove(journal_path.c_str());
+    verify_order_book_state(recovered, {{101.0, 1}}, {}, "Auction journal replay");
+    verify_order_book_state(restored, {{101.0, 1}}, {}, "Auction checkpoint and journal tail");
+    assert(!recovered.in_auction() && !restored.in_auction());
+
+    std::cout << "✓ Call auction test PASSED" << std::endl;
+}
+
+void test_threaded_engine() {
+    std::cout << "\n=== Testing Threaded Matching Engine ===" << std::endl;
+
+    MatchingEngineConfig config;
+    config.book = test_config();
+    config.command_capacity = 16; // Small rings so both sides hit full/empty
+    config.event_capacity = 16;
+    MatchingEngine engine(config);
+    engine.start();
+
+    // The producer also drains events, so it must poll while the command ring is full
+    uint64_t next_ack = 1, trades = 0, sweep_trades = 0, sweep = 0, cancel_filled = 0, cancel_unknown = 0;
+    bool cancel_filled_accepted = true, cancel_unknown_accepted = true;
+    auto drain = [&]() {
+        EngineEvent event;
+        while (engine.poll(event)) {
+            if (event.kind == EngineEvent::Kind::Ack) {
+                assert(event.sequence == next_ack); // Commands are acked in submission order
+                cancel_filled_accepted = event.sequence == cancel_filled ? event.accepted : cancel_filled_accepted;
+                cancel_unknown_accepted = event.sequence == cancel_unknown ? event.accepted : cancel_unknown_accepted;
+                ++next_ack;
+            } else if (event.report.type == ExecutionType::Trade) {
+                assert(event.sequence == sweep);
+                ++trades;
+                sweep_trades += event.report.quantity;
+            } else {
+                assert(event.sequence == next_ack); // Reports precede their command's ack
+            }
+        }
+    };
+    auto submit = [&](CommandType type, const Order &order) {
+        uint64_t sequence;
+        while ((sequence = engine.try_submit(type, order)) == 0) {
+            drain();
+            std::this_thread::yield();
+        }
+        return sequence;
+    };
+
+    // Resting sells, a buy that sweeps them all, and cancels of a filled and an unknown order
+    const int num_sells = 1000;
+    for (int i = 1; i <= num_sells; ++i) {
+        submit(CommandType::Add, {static_cast<uint64_t>(i), false, 100.0 + (i % 10) * 0.01, 1, get_nanos()});
+    }
+    sweep = submit(CommandType::Add, {5000, true, 100.09, num_sells, get_nanos()});
+    cancel_filled = submit(CommandType::Cancel, {1, false, 0.0, 0, 0});
+    cancel_unknown = submit(CommandType::Cancel, {999999, false, 0.0, 0, 0});
+    while (next_ack <= cancel_unknown) {
+        drain();
+        std::this_thread::yield();
+    }
+    engine.stop();
+
+    assert(trades == num_sells && sweep_trades == num_sells);
+    assert(!cancel_filled_accepted && !cancel_unknown_accepted);
+    std::vector<PriceLevel> bids, asks;
+    engine.book().get_snapshot(10, bids, asks);
+    assert(bids.empty() && asks.empty());
+    EngineEvent event;
+    assert(!engine.poll(event));
+
+    std::cout << "✓ Threaded matching engine test PASSED" << std::endl;
+}
+
+void test_sharded_engine() {
+    std::cout << "\n=== Testing Sharded Engine ===" << std::endl;
+
+    ShardedEngineConfig config;
+    config.book = test_config();
+    config.num_symbols = 10;
+    config.num_shards = 3;
+    ShardedEngine engine(config);
+    engine.start();
+
+    // The same order IDs on every symbol: books are independent, so each symbol trades once
+    for (uint32_t symbol = 0; symbol < config.num_symbols; ++symbol) {
+        engine.submit(symbol, CommandType::Add, {1, false, 100.0, 20, get_nanos()});
+        engine.submit(symbol, CommandType::Add, {2, true, 100.0, 1 + symbol, get_nanos()});
+    }
+
+    std::vector<uint64_t> traded(config.num_symbols, 0);
+    size_t acks = 0;
+    while (acks < 2 * config.num_symbols) {
+        for (size_t shard = 0; shard < engine.shard_count(); ++shard) {
+            EngineEvent event;
+            while (engine.poll(shard, event)) {
+                uint32_t symbol = engine.symbol_of(shard, event.book);
+                assert(engine.shard_of(symbol) == shard);
+                if (event.kind == EngineEvent::Kind::Ack) {
+                    ++acks;
+                } else if (event.report.type == ExecutionType::Trade) {
+                    traded[symbol] += event.report.quantity;
+                }
+            }
+        }
+        std::this_thread::yield();
+    }
+    engine.stop();
+
+    for (uint32_t symbol = 0; symbol < config.num_symbols; ++symbol) {
+        assert(traded[symbol] == 1 + symbol);
+        std::vector<PriceLevel> bids, asks;
+        engine.book(symbol).get_snapshot(10, bids, asks);
+        assert(bids.empty() && asks.size() == 1 && asks[0].total_quantity == 19 - symbol);
+    }
+
+    std::cout << "✓ Sharded engine test PASSED" << std::endl;
+}
+
+void test_level_updates() {
+    std::cout << "\n=== Testing Incremental Level Updates ===" << std::endl;
+
+    auto same_levels = [](const std::vector<PriceLevel> &a, const std::vector<PriceLevel> &b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i].price != b[i].price || a[i].total_quantity != b[i].total_quantity) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Hand-checked sequence at depth 2
+    {
+        OrderBook book(test_config());
+        L2MirrorBook mirror(2);
+        std::vector<LevelUpdate> updates;
+        struct Recorder : LevelUpdateListener {
+            std::vector<LevelUpdate> *updates;
+            L2MirrorBook *mirror;
+            void on_level_update(const LevelUpdate &update) override {
+                updates->push_back(update);
+                mirror->on_level_update(update);
+            }
+        } recorder;
+        recorder.updates = &updates;
+        recorder.mirror = &mirror;
+        book.add_order({1, false, 101.0, 10, get_nanos()});
+        book.set_level_update_listener(&recorder, 2); // Replays the existing level
+        book.add_order({2, false, 102.0, 5, get_nanos()});
+        book.add_order({3, false, 103.0, 7, get_nanos()}); // Below depth: nothing published
+        book.add_order({4, false, 100.0, 3, get_nanos()}); // New best pushes 102 out of view
+        book.add_order({5, true, 100.0, 3, get_nanos()});  // Fills the best level
+        assert(updates.size() == 5);
+        assert(updates[0].type == LevelUpdateType::New && updates[0].level == 0 && updates[0].price == 101.0);
+        assert(updates[1].type == LevelUpdateType::New && updates[1].level == 1 && updates[1].quantity == 5);
+        assert(updates[2].type == LevelUpdateType::New && updates[2].level == 0 && updates[2].price == 100.0);
+        assert(updates[3].type == LevelUpdateType::Delete && updates[3].level == 0 && !updates[3].is_buy);
+        assert(updates[4].type == LevelUpdateType::New && updates[4].level == 1 && updates[4].price == 102.0);
+        book.cancel_order(1); // Delete at the top, then 103 comes into view
+        assert(updates.size() == 7 && updates[5].type == LevelUpdateType::Delete);
+        assert(updates.back().type == LevelUpdateType::New && updates.back().price == 103.0);
+        assert(mirror.asks().size() == 2 && mirror.asks()[0].price == 102.0 && mirror.asks()[1].price == 103.0);
+        book.set_level_update_listener(nullptr);
+    }
+
+    // A mirror driven only by updates matches get_snapshot after every operation
+    for (const WorkloadConfig &workload : {uniform_workload(7), hft_workload(7)}) {
+        const size_t depth = 5;
+        OrderBook book(test_config());
+        L2MirrorBook mirror(depth);
+        std::vector<WorkloadOp> ops = WorkloadGenerator(workload).generate(20000);
+        std::vector<PriceLevel> bids, asks;
+        for (size_t i = 0; i < ops.size(); ++i) {
+            if (i == 500) {
+                book.set_level_update_listener(&mirror, depth); // Attach to a populated book
+            }
+            apply_op(book, ops[i]);
+            if (i >= 500) {
+                book.get_snapshot(depth, bids, asks);
+                assert(same_levels(mirror.bids(), bids));
+                assert(same_levels(mirror.asks(), asks));
+            }
+        }
+        book.set_level_update_listener(nullptr);
+    }
+
+    std::cout << "✓ Incremental level update test PASSED" << std::endl;
+}
+
+void test_top_of_book() {
+    std::cout << "\n=== Testing Seqlock Top of Book ===" << std::endl;
+
+    // Published levels track get_snapshot, and only operations that change a level publish
+    {
+        OrderBook book(test_config());
+        TopOfBook top_of_book(3);
+        book.set_top_of_book(&top_of_book);
+        TopOfBookSnapshot snapshot;
+        top_of_book.read(snapshot);
+        assert(snapshot.version == 1 && !snapshot.has_bid() && !snapshot.has_ask());
+
+        std::vector<WorkloadOp> ops = WorkloadGenerator(hft_workload(11)).generate(5000);
+        std::vector<PriceLevel> bids, asks;
+        for (const WorkloadOp &op : ops) {
+            apply_op(book, op);
+            top_of_book.read(snapshot);
+            book.get_snapshot(3, bids, asks);
+            assert(snapshot.bid_count == bids.size() && snapshot.ask_count == asks.size());
+            for (size_t i = 0; i < bids.size(); ++i) {
+                assert(snapshot.bids[i].price == bids[i].price && snapshot.bids[i].total_quantity == bids[i].total_quantity);
+            }
+            for (size_t i = 0; i < asks.size(); ++i) {
+                assert(snapshot.asks[i].price == asks[i].price && snapshot.asks[i].total_quantity == asks[i].total_quantity);
+            }
+        }
+        uint64_t version = top_of_book.version();
+        assert(!book.cancel_order(999999999));
+        assert(top_of_book.version() == version);
+        book.set_top_of_book(nullptr);
+    }
+
+    // Readers never see a half-written publish: every field of a publish carries its index
+    {
+        TopOfBook top_of_book(TopOfBook::kMaxDepth);
+        const uint64_t num_publishes = 200000;
+        std::atomic<bool> torn(false);
+        std::atomic<bool> done(false);
+        auto reader = [&]() {
+            TopOfBookSnapshot snapshot;
+            while (!done.load(std::memory_order_acquire)) {
+                top_of_book.read(snapshot);
+                uint64_t stamp = snapshot.bid_count == 0 ? 0 : snapshot.bids[0].total_quantity;
+                bool consistent = snapshot.bid_count == snapshot.ask_count;
+                for (size_t i = 0; i < snapshot.bid_count; ++i) {
+                    consistent = consistent && snapshot.bids[i].total_quantity == stamp &&
+                                 snapshot.asks[i].total_quantity == stamp &&
+                                 snapshot.bids[i].price == static_cast<double>(stamp);
+                }
+                if (!consistent) {
+                    torn.store(true);
+                }
+            }
+        };
+        std::thread reader1(reader), reader2(reader);
+        PriceLevel levels[TopOfBook::kMaxDepth];
+        for (uint64_t n = 1; n <= num_publishes; ++n) {
+            for (PriceLevel &level : levels) {
+                level = {static_cast<double>(n), n};
+            }
+            size_t count = 1 + n % TopOfBook::kMaxDepth;
+            top_of_book.publish(levels, count, levels, count);
+        }
+        done.store(true, std::memory_order_release);
+        reader1.join();
+        reader2.join();
+        assert(!torn.load());
+        assert(top_of_book.version() == num_publishes);
+    }
+
+    std::cout << "✓ Top of book test PASSED" << std::endl;
+}
+
+void test_journal_replay() {
+    std::cout << "\n=== Testing Journal Replay ===" << std::endl;
+
+    std::string path = "/tmp/comprehensive_test_" + std::to_string(::getpid()) + ".journal";
+    std::remove(path.c_str());
+    JournalConfig journal_config;
+    journal_config.chunk_records = 1000; // Force several file extensions
+    std::vector<WorkloadOp> ops = WorkloadGenerator(hft_workload(3)).generate(12000);
+
+    // Journal the first part, reopen and continue, as after a restart
+    OrderBook live(test_config());
+    {
+        JournalWriter journal;
+        assert(journal.open(path, journal_config));
+        live.set_journal(&journal);
+        for (size_t i = 0; i < 8000; ++i) {
+            apply_op(live, ops[i]);
+        }
+        live.set_journal(nullptr);
+    }
+    {
+        JournalWriter journal;
+        assert(journal.open(path, journal_config));
+        size_t resumed_at = journal.size();
+        live.set_journal(&journal);
+        for (size_t i = 8000; i < ops.size(); ++i) {
+            apply_op(live, ops[i]);
+        }
+        live.set_journal(nullptr);
+        assert(journal.size() > resumed_at && journal.failed_appends() == 0);
+    }
+
+    // Only accepted commands are journaled, and replay rebuilds the same book
+    JournalReader reader;
+    assert(reader.open(path));
+    assert(reader.header().durable_records == reader.for_each([](const JournalRecord &) {}));
+    assert(reader.header().durable_records < ops.size()); // Cancels of filled orders were rejected
+    OrderBook recovered(test_config());
+    reader.replay(recovered);
+
+    std::vector<PriceLevel> live_bids, live_asks, recovered_bids, recovered_asks;
+    live.get_snapshot(100000, live_bids, live_asks);
+    recovered.get_snapshot(100000, recovered_bids, recovered_asks);
+    assert(!live_bids.empty() && !live_asks.empty());
+    assert(live_bids.size() == recovered_bids.size() && live_asks.size() == recovered_asks.size());
+    for (size_t i = 0; i < live_bids.size(); ++i) {
+        assert(live_bids[i].price == recovered_bids[i].price);
+        assert(live_bids[i].total_quantity == recovered_bids[i].total_quantity);
+    }
+    for (size_t i = 0; i < live_asks.size(); ++i) {
+        assert(live_asks[i].price == recovered_asks[i].price);
+        assert(live_asks[i].total_quantity == recovered_asks[i].total_quantity);
+    }
+
+    reader.close();
+    std::remove(path.c_str());
+
+    // Growth that cannot reserve its blocks fails the append instead of faulting later on the
+    // mapped write, and leaves the file at its last good size
+    rlimit file_limit;
+    assert(::getrlimit(RLIMIT_FSIZE, &file_limit) == 0);
+    rlimit small_limit = file_limit;
+    small_limit.rlim_cur = sizeof(JournalHeader) + 1536 * sizeof(JournalRecord);
+    void (*previous_handler)(int) = std::signal(SIGXFSZ, SIG_IGN);
+    assert(::setrlimit(RLIMIT_FSIZE, &small_limit) == 0);
+    {
+        JournalConfig limited;
+        limited.chunk_records = 1024;
+        limited.flush_interval = std::chrono::milliseconds(0); // Grow on this thread
+        JournalWriter journal;
+        assert(journal.open(path, limited));
+        size_t appended = 0;
+        for (uint64_t id = 0; id < 2048; ++id) {
+            appended += journal.append_cancel(id);
+        }
+        assert(appended == 1024 && journal.failed_appends() == 1024);
+        struct stat st;
+        assert(::stat(path.c_str(), &st) == 0 && st.st_size == static_cast<off_t>(sizeof(JournalHeader) + 1024 * sizeof(JournalRecord)));
+    }
+    assert(::setrlimit(RLIMIT_FSIZE, &file_limit) == 0);
+    std::signal(SIGXFSZ, previous_handler);
+    std::remove(path.c_str());
+    std::cout << "✓ Journal replay test PASSED" << std::endl;
+}
+
+void test_checkpoint_restore() {
+    std::cout << "\n=== Testing Checkpoint Restore ===" << std::endl;
+
+    std::string base = "/tmp/comprehensive_test_" + std::to_string(::getpid());
+    std::string journal_path = base + ".ckpt.journal";
+    std::string checkpoint_path = base + ".checkpoint";
+    std::remove(journal_path.c_str());
+    std::vector<WorkloadOp> ops = WorkloadGenerator(hft_workload(5)).generate(14000);
+
+    // Checkpoint part way through a journaled session
+    OrderBookConfig config = test_config();
+    config.max_ladder_window = 1 << 12;
+    config.max_depth_window = 1 << 10;
+    OrderBook live(config);
+    {
+        JournalWriter journal;
+        assert(journal.open(journal_path));
+        live.set_journal(&journal);
+        for (size_t i = 0; i < 10000; ++i) {
+            apply_op(live, ops[i]);
+            if (i == 6000) {
+                assert(live.save_checkpoint(checkpoint_path));
+            }
+        }
+        live.set_journal(nullptr);
+    }
+
+    // Recover: load the checkpoint, then replay only the journal tail
+    CheckpointInfo info;
+    assert(OrderBook::read_checkpoint_info(checkpoint_path, info));
+    assert(info.config.level_storage == g_level_storage && info.config.order_index == g_order_index);
+    assert(info.journal_records > 0 && info.order_count > 0);
+    assert(info.config.max_ladder_window == 1 << 12 && info.config.max_depth_window == 1 << 10);
+    OrderBook restored(info.config);
+    assert(restored.load_checkpoint(checkpoint_path));
+    assert(restored.order_count() == info.order_count);
+    assert(!restored.load_checkpoint(checkpoint_path)); // Only into an empty book
+    OrderBook wrong_tick(test_config(0.001));
+    assert(!wrong_tick.load_checkpoint(checkpoint_path));
+    JournalReader reader;
+    assert(reader.open(journal_path));
+    reader.replay(restored, info.journal_records);
+    assert(restored.order_count() == live.order_count());
+
+    // Same levels, and the same FIFO queues: identical executions from here on
+    std::vector<PriceLevel> live_bids, live_asks, restored_bids, restored_asks;
+    live.get_snapshot(100000, live_bids, live_asks);
+    restored.get_snapshot(100000, restored_bids, restored_asks);
+    assert(live_bids.size() == restored_bids.size() && live_asks.size() == restored_asks.size());
+    for (size_t i = 0; i < live_bids.size(); ++i) {
+        assert(live_bids[i].price == restored_bids[i].price && live_bids[i].total_quantity == restored_bids[i].total_quantity);
+    }
+    for (size_t i = 0; i < live_asks.size(); ++i) {
+        assert(live_asks[i].price == restored_asks[i].price && live_asks[i].total_quantity == restored_asks[i].total_quantity);
+    }
+    ExecutionReportBuffer live_reports(1 << 16), restored_reports(1 << 16);
+    live.set_execution_listener(&live_reports);
+    restored.set_execution_listener(&restored_reports);
+    for (size_t i = 10000; i < ops.size(); ++i) {
+        apply_op(live, ops[i]);
+        apply_op(restored, ops[i]);
+    }
+    assert(live_reports.size() == restored_reports.size() && live_reports.dropped() == 0);
+    for (size_t i = 0; i < live_reports.size(); ++i) {
+        assert(live_reports[i].type == restored_reports[i].type);
+        assert(live_reports[i].order_id == restored_reports[i].order_id);
+        assert(live_reports[i].resting_order_id == restored_reports[i].resting_order_id);
+        assert(live_reports[i].quantity == restored_reports[i].quantity);
+    }
+    live.set_execution_listener(nullptr);
+    restored.set_execution_listener(nullptr);
+
+    reader.close();
+    std::remove(journal_path.c_str());
+
+    // A zero quantity or an order ID saved twice fails the load and leaves the book empty
+    OrderBook small(test_config());
+    small.add_order({1, true, 99.0, 10, 1, 7});
+    small.add_order({2, false, 101.0, 20, 2, 7});
+    assert(small.save_checkpoint(checkpoint_path));
+    std::vector<char> saved(sizeof(CheckpointHeader) + 2 * (sizeof(CheckpointLevel) + sizeof(CheckpointOrder)));
+    std::FILE *file = std::fopen(checkpoint_path.c_str(), "rb");
+    assert(file != nullptr && std::fread(saved.data(), 1, saved.size(), file) == saved.size());
+    std::fclose(file);
+    size_t second_order = sizeof(CheckpointHeader) + 2 * sizeof(CheckpointLevel) + sizeof(CheckpointOrder);
+    for (int corruption = 0; corruption < 2; ++corruption) {
+        std::vector<char> bad = saved;
+        CheckpointOrder order;
+        std::memcpy(&order, bad.data() + second_order, sizeof(order));
+        if (corruption == 0) {
+            order.order_id = 1;
+        } else {
+            order.quantity = 0;
+        }
+        std::memcpy(bad.data() + second_order, &order, sizeof(order));
+        file = std::fopen(checkpoint_path.c_str(), "wb");
+        assert(file != nullptr && std::fwrite(bad.data(), 1, bad.size(), file) == bad.size());
+        std::fclose(file);
+
+        OrderBook rejected(test_config());
+        assert(!rejected.load_checkpoint(checkpoint_path));
+        Order found;
+        assert(rejected.order_count() == 0 && rejected.memory_pool_stats().live == 0 && !rejected.find_order(1, found));
+        assert(rejected.mass_cancel({7, true, true}) == 0);
+        verify_order_book_state(rejected, {}, {}, "Rejected checkpoint leaves the book empty");
+        rejected.add_order({1, true, 99.0, 5, 1});
+        verify_order_book_state(rejected, {{99.0, 5}}, {}, "Book usable after a rejected checkpoint");
+    }
+    std::remove(checkpoint_path.c_str());
+    std::cout << "✓ Checkpoint restore test PASSED" << std::endl;
+}
+
+void test_capture_replay() {
+    std::cout << "\n=== Testing Capture Replay ===" << std::endl;
+
+    std::string path = "/tmp/comprehensive_test_" + std::to_string(::getpid()) + ".capture";
+    {
+        CaptureWriter writer;
+        assert(writer.open(path, 0.01));
+        writer.write_add(1, 1, true, 100, 1000000);   // Buy 100 @ 100.00
+        writer.write_add(2, 2, true, 50, 1000000);    // Buy 50 @ 100.00
+        writer.write_add(3, 3, false, 70, 1010000);   // Sell 70 @ 101.00
+        writer.write_cancel(4, 1, 30);                // Order 1 keeps priority with 70 left
+        writer.write_execute(5, 2, 50, 1);            // Order 2 fully executed
+        writer.write_replace(6, 3, 4, 40, 1005000);   // Order 3 becomes sell 40 @ 100.50
+        writer.write_delete(7, 99);                   // Unknown order
+        assert(writer.message_count() == 7);
+        assert(writer.close());
+    }
+
+    CaptureReader reader;
+    assert(reader.open(path));
+    assert(reader.header().message_count == 7 && reader.header().tick_size == 0.01);
+    OrderBook book(test_config());
+    size_t rejected = 0;
+    size_t messages = reader.for_each([&](const CaptureEvent &event) {
+        rejected += !apply_capture_event(book, event);
+    });
+    assert(messages == 7 && rejected == 1);
+    verify_order_book_state(book, {{100.0, 70}}, {{100.5, 40}}, "Capture messages applied");
+    Order resting;
+    assert(book.find_order(1, resting) && resting.quantity == 70);
+    assert(!book.find_order(2, resting) && !book.find_order(3, resting));
+    assert(book.find_order(4, resting) && !resting.is_buy);
+    reader.close();
+
+    // A truncated file replays up to the last complete message
+    assert(::truncate(path.c_str(), sizeof(CaptureHeader) + kCaptureAddSize * 2 + 5) == 0);
+    assert(reader.open(path));
+    assert(reader.for_each([](const CaptureEvent &) {}) == 2);
+    reader.close();
+
+    // A generated feed is exchange-consistent: the replay book never trades or misses an order
+    CaptureGeneratorConfig generator_config;
+    generator_config.seed = 11;
+    CaptureGenerator generator(generator_config);
+    {
+        CaptureWriter writer;
+        assert(writer.open(path, generator_config.tick_size));
+        generator.generate(writer, 50000);
+        assert(writer.close());
+    }
+    assert(reader.open(path));
+    OrderBook replayed(test_config());
+    ExecutionReportBuffer reports(1 << 16);
+    replayed.set_execution_listener(&reports);
+    rejected = 0;
+    assert(reader.for_each([&](const CaptureEvent &event) {
+        rejected += !apply_capture_event(replayed, event);
+    }) == 50000);
+    assert(rejected == 0 && replayed.order_count() == generator.live_orders());
+    size_t trades = 0;
+    for (size_t i = 0; i < reports.size(); ++i) {
+        trades += reports[i].type == ExecutionType::Trade;
+    }
+    assert(trades == 0 && reports.dropped() == 0);
+    std::vector<PriceLevel> bids, asks;
+    replayed.get_snapshot(1, bids, asks);
+    assert(!bids.empty() && !asks.empty() && bids[0].price < asks[0].price);
+    replayed.set_execution_listener(nullptr);
+
+    reader.close();
+    std::remove(path.c_str());
+    std::cout << "✓ Capture replay test PASSED" << std::endl;
+}
+
 void test_memory_pool() {
     std::cout << "\n=== Testing Memory Pool ===" << std::endl;
 
-    OrderBook book;
-    book.set_verbose(false);
+    OrderBook book(test_config());
     uint64_t id = 1;
 
     // Add many orders to test memory pool allocation
@@ -250,62 +1824,65 @@ void test_memory_pool() {
         book.add_order({id++, (i % 2 == 0), 100.0 + (i % 10), static_cast<uint64_t>(1 + (i % 100)), get_nanos()});
     }
 
+    // Stats track resting nodes; reuse comes from the free list, not new chunks
+    MemoryPoolStats stats = book.memory_pool_stats();
+    assert(stats.live == book.order_count());
+    assert(stats.peak >= stats.live && stats.peak <= 10000);
+    assert(stats.capacity >= test_config().expected_orders && stats.chunks == 1);
+
+    // Order nodes: index 0 is never handed out, growth keeps contents, freed indices come back first
+    static_assert(sizeof(OrderNodeHot) == 24, "the hot order node half should stay in 24 bytes");
+    static_assert(sizeof(OrderNodeCold) == 40, "the cold order node half should stay in 40 bytes");
+    MemoryPoolConfig pool_config;
+    pool_config.reserve_objects = 100;
+    OrderNodePool node_pool(pool_config);
+    std::vector<NodeIndex> node_indices;
+    for (int i = 0; i < 10000; ++i) {
+        NodeIndex node = node_pool.allocate();
+        assert(node != kNoNode);
+        node_pool.hot(node).order_id = i;
+        node_pool.cold(node).timestamp_ns = i * 2;
+        node_indices.push_back(node);
+    }
+    assert(node_pool.stats().live == 10000 && node_pool.stats().chunks > 1);
+    for (int i = 0; i < 10000; ++i) {
+        assert(node_pool.hot(node_indices[i]).order_id == static_cast<uint64_t>(i));
+        assert(node_pool.cold(node_indices[i]).timestamp_ns == static_cast<uint64_t>(i * 2));
+    }
+    node_pool.release(node_indices[5]);
+    assert(node_pool.allocate() == node_indices[5]);
+    node_pool.reserve(50000);
+    assert(node_pool.stats().capacity >= 50000 && node_pool.hot(node_indices[9999]).order_id == 9999);
+
+    // The huge page and prefault path maps whole 2MB pages
+    pool_config.huge_pages = true;
+    pool_config.prefault = true;
+    OrderNodePool huge_pool(pool_config);
+    assert(huge_pool.stats().bytes % (size_t(2) << 20) == 0);
+    NodeIndex huge_node = huge_pool.allocate();
+    huge_pool.hot(huge_node).order_id = 42;
+    huge_pool.release(huge_node);
+
     std::cout << "✓ Memory pool stress test PASSED" << std::endl;
 }
 
 void test_performance() {
     std::cout << "\n=== Testing Performance ===" << std::endl;
 
-    OrderBook book;
-    book.set_verbose(false);
+    OrderBook book(test_config());
 
     const int num_operations = 100000;
-    std::vector<Order> orders;
-    orders.reserve(num_operations);
 
-    std::mt19937_64 rng(42);  // Fixed seed for reproducibility
-    std::uniform_real_distribution<double> price_dist(95.0, 105.0);
-    std::uniform_int_distribution<uint64_t> quantity_dist(1, 100);
-    std::uniform_int_distribution<int> op_dist(0, 100);
-
-    uint64_t order_id_counter = 1;
-    std::vector<uint64_t> active_order_ids;
-    active_order_ids.reserve(num_operations);
+    // 70/20/10 add/cancel/amend mix with a fixed seed for reproducibility
+    WorkloadConfig workload = uniform_workload(42);
+    workload.add_pct = 70;
+    workload.cancel_pct = 20;
+    std::vector<WorkloadOp> ops = WorkloadGenerator(workload).generate(num_operations);
 
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    for (int i = 0; i < num_operations; ++i) {
-        int op = op_dist(rng);
-
-        if (op < 70 || active_order_ids.empty()) { // 70% Add
-            bool is_buy = (op % 2 == 0);
-            double price = std::round(price_dist(rng) * 100.0) / 100.0;
-            uint64_t quantity = quantity_dist(rng);
-            uint64_t order_id = order_id_counter++;
-
-            book.add_order({order_id, is_buy, price, quantity, get_nanos()});
-            active_order_ids.push_back(order_id);
-
-        } else if (op < 90) { // 20% Cancel
-            if (!active_order_ids.empty()) {
-                std::uniform_int_distribution<size_t> id_dist(0, active_order_ids.size() - 1);
-                size_t idx = id_dist(rng);
-                uint64_t id_to_cancel = active_order_ids[idx];
-                book.cancel_order(id_to_cancel);
-                std::swap(active_order_ids[idx], active_order_ids.back());
-                active_order_ids.pop_back();
-            }
-
-        } else { // 10% Amend
-            if (!active_order_ids.empty()) {
-                std::uniform_int_distribution<size_t> id_dist(0, active_order_ids.size() - 1);
-                size_t idx = id_dist(rng);
-                uint64_t id_to_amend = active_order_ids[idx];
-                double new_price = std::round(price_dist(rng) * 100.0) / 100.0;
-                uint64_t new_quantity = quantity_dist(rng);
-                book.amend_order(id_to_amend, new_price, new_quantity);
-            }
-        }
+    for (const WorkloadOp &op : ops) {
+        apply_op(book, op);
     }
 
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -331,8 +1908,7 @@ void test_performance() {
 void test_snapshot_functionality() {
     std::cout << "\n=== Testing Snapshot Functionality ===" << std::endl;
 
-    OrderBook book;
-    book.set_verbose(false);
+    OrderBook book(test_config());
     uint64_t id = 1;
 
     // Add orders at different price levels
@@ -362,13 +1938,42 @@ int main() {
     std::cout << "Starting Comprehensive Order Book Tests..." << std::endl;
 
     try {
-        test_basic_order_operations();
-        test_matching_engine();
-        test_fifo_ordering();
-        test_edge_cases();
-        test_memory_pool();
-        test_snapshot_functionality();
-        test_performance();
+        for (int combination = 0; combination < 4; ++combination) {
+            g_level_storage = (combination & 1) ? LevelStorage::Ladder : LevelStorage::Map;
+            g_order_index = (combination & 2) ? OrderIndexPolicy::Slab : OrderIndexPolicy::Hash;
+            std::cout << "\n##### Level storage: "
+                      << (g_level_storage == LevelStorage::Map ? "map" : "ladder")
+                      << ", order index: "
+                      << (g_order_index == OrderIndexPolicy::Hash ? "hash" : "slab") << " #####" << std::endl;
+
+            test_basic_order_operations();
+            test_matching_engine();
+            test_fifo_ordering();
+            test_edge_cases();
+            test_tick_prices();
+            test_ladder_recentering();
+            test_sparse_book_emptying();
+            test_level_pool();
+            test_order_id_window();
+            test_execution_reports();
+            test_batch_commands();
+            test_policy_books();
+            test_time_in_force();
+            test_level_sweeps();
+            test_amend_priority();
+            test_mass_cancel();
+            test_call_auction();
+            test_level_updates();
+            test_top_of_book();
+            test_journal_replay();
+            test_checkpoint_restore();
+            test_capture_replay();
+            test_threaded_engine();
+            test_sharded_engine();
+            test_memory_pool();
+            test_snapshot_functionality();
+            test_performance();
+        }
 
         std::cout << "\n🎉 ALL TESTS PASSED! 🎉" << std::endl;
         std::cout << "Order Book implementation is working correctly!" << std::endl;
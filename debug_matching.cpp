@@ -3,6 +3,8 @@
 #include <iomanip>
 #include <chrono>
 
+using namespace OrderBookSystem;
+
 inline uint64_t get_nanos() {
     return std::chrono::duration_cast<std::chrono::nanoseconds>(
         std::chrono::high_resolution_clock::now().time_since_epoch()
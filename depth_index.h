@@ -0,0 +1,238 @@
+#pragma once
+
+#include "price_ticks.h"
+#include "level_bitmap.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility> // for std::move
+#include <vector>
+
+namespace OrderBookSystem {
+
+// Cumulative resting quantity for one side of the book: a Fenwick (binary indexed) tree over a
+// window of tick offsets, ordered best price first, so "quantity at or better than P" is a
+// prefix sum and "how deep does Q go" is a descent, both O(log window). Each node also sums
+// price x quantity in ticks, for the notional of a fill. The window re-centres (growing if
+// needed) when a level appears outside it, like PriceLadder; each slot costs 24 bytes. It
+// never grows past max_window slots: levels that cannot fit alongside the others are summed
+// from a small sorted side map instead, which costs a walk of that map per query.
+class CumulativeDepth {
+public:
+    CumulativeDepth(bool is_bid, size_t capacity, size_t max_window)
+        : is_bid_(is_bid), base_(0), total_(0), far_total_(0), levels_(0) {
+        size_t slots = 1;
+        while (slots < capacity) {
+            slots *= 2;
+        }
+        max_slots_ = slots;
+        while (max_slots_ < max_window) {
+            max_slots_ *= 2;
+        }
+        resize(slots);
+    }
+
+    // Record the total quantity now resting at price (0 once the level is gone).
+    void set(PriceTicks price, uint64_t quantity) {
+        PriceTicks key = to_key(price);
+        if (!in_window(key)) {
+            if (quantity == 0 || far_.count(key) != 0 || !recenter(key)) {
+                set_far(key, quantity);
+                return;
+            }
+        }
+        size_t slot = static_cast<size_t>(key - base_);
+        uint64_t old = quantity_[slot];
+        if (old == quantity) {
+            return;
+        }
+        levels_ += (old == 0) - (quantity == 0);
+        if (old == 0) {
+            occupied_.set(slot);
+        } else if (quantity == 0) {
+            occupied_.clear(slot);
+        }
+        // Unsigned wrap-around makes a decrease an ordinary addition
+        uint64_t delta = quantity - old;
+        uint64_t notional_delta = delta * static_cast<uint64_t>(price);
+        quantity_[slot] = quantity;
+        total_ += delta;
+        for (size_t i = slot + 1; i <= quantity_.size(); i += i & (~i + 1)) {
+            tree_[i].quantity += delta;
+            tree_[i].notional += notional_delta;
+        }
+    }
+
+    uint64_t total() const { return total_; }
+
+    // Quantity at price or better (higher for bids, lower for asks).
+    uint64_t at_or_better(PriceTicks price) const {
+        PriceTicks key = to_key(price);
+        uint64_t sum = 0;
+        if (in_window(key)) {
+            for (size_t i = static_cast<size_t>(key - base_) + 1; i > 0; i &= i - 1) {
+                sum += tree_[i].quantity;
+            }
+        } else if (key >= base_) {
+            sum = total_ - far_total_; // The whole window
+        }
+        for (auto it = far_.begin(); far_total_ != 0 && it != far_.end() && it->first <= key; ++it) {
+            sum += it->second;
+        }
+        return sum;
+    }
+
+    // Take quantity (0 < quantity <= total()) from the best level down: worst receives the
+    // price of the last level reached and notional the sum of price x quantity, in ticks.
+    void fill(uint64_t quantity, PriceTicks &worst, int64_t &notional) const {
+        uint64_t remaining = quantity;
+        uint64_t sum = 0;
+        // Side-map levels better than the window, the window, then side-map levels worse than it
+        auto it = far_.begin();
+        for (; it != far_.end() && it->first < base_; ++it) {
+            if (take_far(*it, remaining, worst, sum)) {
+                notional = static_cast<int64_t>(sum);
+                return;
+            }
+        }
+        uint64_t window = total_ - far_total_;
+        if (remaining > window) {
+            sum += tree_[quantity_.size()].notional; // The root covers every slot
+            remaining -= window;
+            for (; it != far_.end(); ++it) {
+                if (take_far(*it, remaining, worst, sum)) {
+                    break;
+                }
+            }
+            notional = static_cast<int64_t>(sum);
+            return;
+        }
+
+        size_t pos = 0;
+        for (size_t step = quantity_.size(); step > 0; step /= 2) {
+            if (pos + step <= quantity_.size() && tree_[pos + step].quantity < remaining) {
+                pos += step;
+                remaining -= tree_[pos].quantity;
+                sum += tree_[pos].notional;
+            }
+        }
+        // Slot pos is the level where the running total reaches quantity
+        worst = from_key(base_ + static_cast<PriceTicks>(pos));
+        notional = static_cast<int64_t>(sum + remaining * static_cast<uint64_t>(worst));
+    }
+
+private:
+    // Keys grow from best to worst on both sides
+    PriceTicks to_key(PriceTicks price) const { return is_bid_ ? -price : price; }
+    PriceTicks from_key(PriceTicks key) const { return is_bid_ ? -key : key; }
+
+    bool in_window(PriceTicks key) const {
+        return key >= base_ && key < base_ + static_cast<PriceTicks>(quantity_.size());
+    }
+
+    // Take up to remaining from one side-map level; true once remaining reaches 0
+    bool take_far(const std::pair<const PriceTicks, uint64_t> &level, uint64_t &remaining, PriceTicks &worst,
+                  uint64_t &sum) const {
+        uint64_t take = remaining < level.second ? remaining : level.second;
+        worst = from_key(level.first);
+        sum += take * static_cast<uint64_t>(worst);
+        remaining -= take;
+        return remaining == 0;
+    }
+
+    void set_far(PriceTicks key, uint64_t quantity) {
+        auto it = far_.find(key);
+        uint64_t old = it == far_.end() ? 0 : it->second;
+        if (quantity == 0) {
+            if (it != far_.end()) {
+                far_.erase(it);
+            }
+        } else if (it == far_.end()) {
+            far_.emplace(key, quantity);
+        } else {
+            it->second = quantity;
+        }
+        total_ += quantity - old;
+        far_total_ += quantity - old;
+    }
+
+    void resize(size_t slots) {
+        quantity_.assign(slots, 0);
+        tree_.assign(slots + 1, TreeNode{0, 0});
+        occupied_.reset(slots);
+    }
+
+    // Move the window so that it covers key and every non-empty slot, pull in side-map levels
+    // it then covers, and rebuild the trees. Returns false, leaving the window unchanged, if
+    // that would take more than max_slots_ slots.
+    bool recenter(PriceTicks key) {
+        PriceTicks lo = key;
+        PriceTicks hi = key;
+        if (levels_ > 0) {
+            // The occupancy bitmap gives the occupied range in one word per layer
+            PriceTicks lowest = base_ + static_cast<PriceTicks>(occupied_.next_set(0));
+            PriceTicks highest = base_ + static_cast<PriceTicks>(occupied_.prev_set(quantity_.size() - 1));
+            lo = lowest < lo ? lowest : lo;
+            hi = highest > hi ? highest : hi;
+        }
+        if (static_cast<uint64_t>(hi - lo) >= max_slots_) {
+            return false;
+        }
+        size_t span = static_cast<size_t>(hi - lo) + 1;
+        size_t slots = quantity_.size();
+        while (slots < span * 2 && slots < max_slots_) {
+            slots *= 2;
+        }
+        PriceTicks new_base = lo - static_cast<PriceTicks>((slots - span) / 2);
+
+        std::vector<uint64_t> old_quantity;
+        old_quantity.swap(quantity_);
+        LevelBitmap old_occupied = std::move(occupied_);
+        PriceTicks old_base = base_;
+        resize(slots);
+        base_ = new_base;
+        for (size_t slot = old_occupied.next_set(0); slot != LevelBitmap::npos; slot = old_occupied.next_set(slot + 1)) {
+            size_t moved = static_cast<size_t>(old_base + static_cast<PriceTicks>(slot) - base_);
+            quantity_[moved] = old_quantity[slot];
+            occupied_.set(moved);
+        }
+        PriceTicks end = base_ + static_cast<PriceTicks>(slots);
+        for (auto it = far_.lower_bound(base_); it != far_.end() && it->first < end; it = far_.erase(it)) {
+            quantity_[static_cast<size_t>(it->first - base_)] = it->second;
+            occupied_.set(static_cast<size_t>(it->first - base_));
+            far_total_ -= it->second;
+            ++levels_;
+        }
+        // Linear-time build: each node passes its sum up to its parent
+        for (size_t i = 1; i <= slots; ++i) {
+            uint64_t quantity = quantity_[i - 1];
+            tree_[i].quantity += quantity;
+            tree_[i].notional += quantity * static_cast<uint64_t>(from_key(base_ + static_cast<PriceTicks>(i - 1)));
+            size_t parent = i + (i & (~i + 1));
+            if (parent <= slots) {
+                tree_[parent].quantity += tree_[i].quantity;
+                tree_[parent].notional += tree_[i].notional;
+            }
+        }
+        return true;
+    }
+
+    // Both sums of one Fenwick node share a cache line
+    struct TreeNode {
+        uint64_t quantity;
+        uint64_t notional; // Price x quantity in ticks, modulo 2^64
+    };
+
+    bool is_bid_;
+    PriceTicks base_;                     // Key of slot 0
+    uint64_t total_;                      // Window and side map
+    uint64_t far_total_;                  // Side map only
+    size_t levels_;                       // Non-empty slots
+    size_t max_slots_;                    // Largest window, a power of two
+    std::vector<uint64_t> quantity_;      // Per slot
+    std::vector<TreeNode> tree_;          // Fenwick tree, 1-based
+    LevelBitmap occupied_;                // One bit per non-empty slot
+    std::map<PriceTicks, uint64_t> far_;  // Quantity of levels outside the window, by key
+};
+
+} // namespace OrderBookSystem
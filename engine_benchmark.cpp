@@ -0,0 +1,157 @@
+#include "matching_engine.h"
+#include "latency_histogram.h"
+#include "workload.h"
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+using namespace OrderBookSystem;
+
+// Two-thread benchmark of MatchingEngine: the gateway thread (main) submits a pre-generated
+// workload and drains the event ring; the matching thread runs the book. Latency is measured
+// from just before a command is enqueued to when the gateway sees its ack.
+
+struct Options {
+    LevelStorage storage = LevelStorage::Map;
+    OrderIndexPolicy index = OrderIndexPolicy::Hash;
+    bool hft = false;
+    size_t ops = 2000000;
+    uint64_t seed = 42;
+    int gateway_cpu = 0;  // -1 disables pinning
+    int engine_cpu = 1;   // -1 disables pinning
+};
+
+struct RunResult {
+    LatencyHistogram latency;
+    double ops_per_sec = 0.0;
+    uint64_t events = 0;
+    bool engine_pinned = false;
+};
+
+CommandType command_type(OpType type) {
+    switch (type) {
+        case OpType::Add:    return CommandType::Add;
+        case OpType::Cancel: return CommandType::Cancel;
+        default:             return CommandType::Amend;
+    }
+}
+
+// Keeps at most max_inflight unacknowledged commands in the engine
+RunResult run(const Options &options, const std::vector<WorkloadOp> &ops, size_t max_inflight) {
+    MatchingEngineConfig config;
+    config.book = OrderBookConfig(false, 10, 0.01);
+    config.book.level_storage = options.storage;
+    config.book.order_index = options.index;
+    config.cpu = options.engine_cpu;
+    MatchingEngine engine(config);
+    engine.start();
+
+    RunResult result;
+    std::vector<uint64_t> submit_ticks(ops.size() + 1);
+    size_t submitted = 0;
+    uint64_t acked = 0;
+    EngineEvent event;
+    SpinWait idle;
+
+    uint64_t run_start = TscClock::start();
+    while (acked < ops.size()) {
+        bool progressed = false;
+        if (submitted < ops.size() && submitted - acked < max_inflight) {
+            const WorkloadOp &op = ops[submitted];
+            uint64_t t0 = TscClock::start();
+            uint64_t sequence = engine.try_submit(command_type(op.type), op.order);
+            if (sequence != 0) {
+                submit_ticks[sequence] = t0;
+                ++submitted;
+                progressed = true;
+            }
+        }
+        while (engine.poll(event)) {
+            progressed = true;
+            ++result.events;
+            if (event.kind == EngineEvent::Kind::Ack) {
+                result.latency.record(TscClock::stop() - submit_ticks[event.sequence]);
+                ++acked;
+            }
+        }
+        if (progressed) {
+            idle.reset();
+        } else {
+            idle.wait();
+        }
+    }
+    uint64_t run_end = TscClock::stop();
+    result.engine_pinned = engine.pinned();
+    engine.stop();
+
+    result.ops_per_sec = static_cast<double>(ops.size()) / (run_end - run_start);
+    return result;
+}
+
+Options parse_options(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--storage") {
+            options.storage = std::strcmp(value, "ladder") == 0 ? LevelStorage::Ladder : LevelStorage::Map;
+        } else if (arg == "--index") {
+            options.index = std::strcmp(value, "slab") == 0 ? OrderIndexPolicy::Slab : OrderIndexPolicy::Hash;
+        } else if (arg == "--workload") {
+            options.hft = std::strcmp(value, "hft") == 0;
+        } else if (arg == "--ops") {
+            options.ops = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--gateway-cpu") {
+            options.gateway_cpu = std::atoi(value);
+        } else if (arg == "--engine-cpu") {
+            options.engine_cpu = std::atoi(value);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--storage map|ladder] [--index hash|slab] [--workload uniform|hft]"
+                      << " [--ops N] [--seed N] [--gateway-cpu N|-1] [--engine-cpu N|-1]" << std::endl;
+            std::exit(1);
+        }
+        ++i;
+    }
+    return options;
+}
+
+void print_row(const char *name, const RunResult &result, double ticks_per_ns) {
+    const LatencyHistogram &h = result.latency;
+    std::cout << std::setw(12) << std::left << name << std::right << std::fixed << std::setprecision(0)
+              << std::setw(12) << result.ops_per_sec * ticks_per_ns * 1e9
+              << std::setw(9) << h.mean() / ticks_per_ns
+              << std::setw(9) << h.percentile(50.0) / ticks_per_ns
+              << std::setw(9) << h.percentile(99.0) / ticks_per_ns
+              << std::setw(9) << h.percentile(99.9) / ticks_per_ns
+              << std::setw(11) << h.max() / ticks_per_ns << std::endl;
+}
+
+int main(int argc, char **argv) {
+    Options options = parse_options(argc, argv);
+    bool pinned = pin_current_thread(options.gateway_cpu);
+
+    WorkloadConfig workload = options.hft ? hft_workload(options.seed) : uniform_workload(options.seed);
+    std::vector<WorkloadOp> ops = WorkloadGenerator(workload).generate(options.ops);
+    double ticks_per_ns = TscClock::calibrate();
+
+    // Saturated: as many commands in flight as the command ring holds. Ping-pong: one at a time,
+    // so latency is the bare round trip through both rings.
+    RunResult saturated = run(options, ops, MatchingEngineConfig().command_capacity);
+    RunResult ping_pong = run(options, ops, 1);
+
+    std::cout << "--- Enqueue-to-Ack Latency (ns; gateway " << (pinned ? "pinned" : "not pinned")
+              << ", engine " << (saturated.engine_pinned ? "pinned" : "not pinned") << ") ---\n";
+    std::cout << std::setw(12) << std::left << "mode" << std::right << std::setw(12) << "ops/sec"
+              << std::setw(9) << "mean" << std::setw(9) << "p50" << std::setw(9) << "p99"
+              << std::setw(9) << "p99.9" << std::setw(11) << "max" << std::endl;
+    print_row("saturated", saturated, ticks_per_ns);
+    print_row("ping-pong", ping_pong, ticks_per_ns);
+    std::cout << "Events per command: " << std::setprecision(2)
+              << static_cast<double>(saturated.events) / ops.size() << std::endl;
+    return 0;
+}
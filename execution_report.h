@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OrderBookSystem {
+
+// Kind of event reported by the matching engine
+enum class ExecutionType : uint8_t {
+    Trade,     // An incoming order filled (part of) a resting order
+    Rested,    // The remaining quantity of an incoming order now rests on the book
+    Cancelled, // Quantity left the book untraded: a resting order removed by cancel_order, a
+               // batched cancel or mass_cancel, or the unfilled part of an IOC or FOK order
+    Amended    // A resting order was amended (re-entered first if the price changed)
+};
+
+// Fixed-layout execution report. Trades carry both sides; a fill is partial when either
+// leaves quantity is non-zero.
+struct ExecutionReport {
+    ExecutionType type;
+    bool is_buy;                      // Side of order_id
+    uint64_t order_id;                // Aggressor for trades, otherwise the order concerned
+    uint64_t resting_order_id;        // Trades only: the passive order that was hit
+    double price;                     // Trade price, or the order's price on the book
+    uint64_t quantity;                // Filled, resting, cancelled or amended quantity
+    uint64_t leaves_quantity;         // Trades only: aggressor quantity still to match
+    uint64_t resting_leaves_quantity; // Trades only: quantity left on the resting order
+
+    bool is_partial_fill() const {
+        return type == ExecutionType::Trade && (leaves_quantity != 0 || resting_leaves_quantity != 0);
+    }
+};
+
+// Receives execution reports synchronously from the matching thread. Implementations must not
+// block; the book calls on_execution from inside its matching loops.
+class ExecutionListener {
+public:
+    virtual ~ExecutionListener() = default;
+    virtual void on_execution(const ExecutionReport &report) = 0;
+
+    // A run of reports from one event, in order (the fills of a level swept whole). The default
+    // delivers them one at a time.
+    virtual void on_executions(const ExecutionReport *reports, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            on_execution(reports[i]);
+        }
+    }
+};
+
+// Preallocated ring buffer of execution reports. Recording never allocates; once full, new
+// reports are dropped and counted until the consumer drains the buffer.
+class ExecutionReportBuffer : public ExecutionListener {
+public:
+    explicit ExecutionReportBuffer(size_t capacity = 4096)
+        : reports_(round_up_pow2(capacity)), mask_(reports_.size() - 1),
+          head_(0), tail_(0), dropped_(0) {}
+
+    void on_execution(const ExecutionReport &report) override {
+        if (tail_ - head_ == reports_.size()) {
+            ++dropped_;
+            return;
+        }
+        reports_[tail_++ & mask_] = report;
+    }
+
+    void on_executions(const ExecutionReport *reports, size_t count) override {
+        size_t free = reports_.size() - size();
+        size_t taken = count < free ? count : free;
+        for (size_t i = 0; i < taken; ++i) {
+            reports_[tail_++ & mask_] = reports[i];
+        }
+        dropped_ += count - taken;
+    }
+
+    size_t size() const { return static_cast<size_t>(tail_ - head_); }
+    bool empty() const { return tail_ == head_; }
+    size_t capacity() const { return reports_.size(); }
+    uint64_t dropped() const { return dropped_; }
+
+    // i-th oldest undrained report
+    const ExecutionReport& operator[](size_t i) const { return reports_[(head_ + i) & mask_]; }
+
+    bool pop(ExecutionReport &report) {
+        if (empty()) {
+            return false;
+        }
+        report = reports_[head_++ & mask_];
+        return true;
+    }
+
+    void clear() {
+        head_ = tail_;
+        dropped_ = 0;
+    }
+
+private:
+    static size_t round_up_pow2(size_t n) {
+        size_t result = 1;
+        while (result < n) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    std::vector<ExecutionReport> reports_;
+    size_t mask_;
+    uint64_t head_;
+    uint64_t tail_;
+    uint64_t dropped_;
+};
+
+} // namespace OrderBookSystem
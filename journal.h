@@ -0,0 +1,399 @@
+#pragma once
+
+#include "common.h"
+#include "order_book_config.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace OrderBookSystem {
+
+enum class JournalRecordType : uint8_t {
+    End = 0, // Unwritten space; replay stops here
+    Add = 1,
+    Cancel = 2,
+    Amend = 3,
+    BeginAuction = 4,
+    Uncross = 5
+};
+
+// One accepted command, 40 bytes. Cancels use order_id only; amends carry the new price and
+// quantity; adds carry the whole order and its TimeInForce. Auction phase changes carry nothing.
+struct JournalRecord {
+    JournalRecordType type;
+    uint8_t is_buy;
+    uint8_t time_in_force;   // TimeInForce of an add; 0 (Day) in journals that predate it
+    uint8_t reserved;
+    uint32_t owner_id;       // Owner of an add; 0 in journals that predate it
+    uint64_t order_id;
+    double price;
+    uint64_t quantity;
+    uint64_t timestamp_ns;
+};
+static_assert(sizeof(JournalRecord) == 40, "JournalRecord layout is part of the file format");
+
+// First 64 bytes of a journal file
+struct JournalHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    double tick_size;          // price_precision of the book that wrote it
+    uint64_t durable_records;  // Records known to be on disk as of the last flush
+    uint8_t reserved[32];
+};
+static_assert(sizeof(JournalHeader) == 64, "JournalHeader layout is part of the file format");
+
+constexpr char kJournalMagic[8] = {'O', 'B', 'J', 'R', 'N', 'L', '\0', '\1'};
+constexpr uint32_t kJournalVersion = 1;
+
+struct JournalConfig {
+    size_t chunk_records = size_t(1) << 20;  // File grows (and is preallocated) this many records at a time
+    size_t max_records = size_t(1) << 30;    // Address space reserved up front (40 GiB of it by default)
+    std::chrono::milliseconds flush_interval{10}; // Background msync period; 0 disables the flusher
+    double tick_size = 0.01;                 // Recorded in the header for readers
+};
+
+// Append-only journal written through a shared mapping of a preallocated file.
+// The whole max_records range is mapped once and the file is extended under it in chunks, so
+// appends are a copy into memory that never remaps. A record becomes visible to replay when
+// its type byte, written last, is set; a process crash therefore loses at most the record
+// being written. A background thread msyncs new records every flush_interval and grows the
+// file ahead of the writer, keeping disk I/O off the appending thread.
+// Appends must come from one thread.
+class JournalWriter {
+public:
+    JournalWriter() = default;
+    ~JournalWriter() { close(); }
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    // Creates the file, or opens an existing journal and continues after its last record.
+    bool open(const std::string &path, const JournalConfig &config = JournalConfig()) {
+        close();
+        config_ = config;
+        config_.chunk_records = config_.chunk_records > 0 ? config_.chunk_records : 1;
+
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) {
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) != 0) {
+            close();
+            return false;
+        }
+        size_t existing_records = st.st_size > static_cast<off_t>(sizeof(JournalHeader))
+            ? (static_cast<size_t>(st.st_size) - sizeof(JournalHeader)) / sizeof(JournalRecord) : 0;
+        if (existing_records > config_.max_records) {
+            config_.max_records = existing_records;
+        }
+
+        map_bytes_ = sizeof(JournalHeader) + config_.max_records * sizeof(JournalRecord);
+        void *map = ::mmap(nullptr, map_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (map == MAP_FAILED) {
+            close();
+            return false;
+        }
+        base_ = static_cast<char*>(map);
+        header_ = reinterpret_cast<JournalHeader*>(base_);
+        records_ = reinterpret_cast<JournalRecord*>(base_ + sizeof(JournalHeader));
+        capacity_.store(existing_records, std::memory_order_relaxed);
+
+        size_t count = 0;
+        if (st.st_size >= static_cast<off_t>(sizeof(JournalHeader))) {
+            if (std::memcmp(header_->magic, kJournalMagic, sizeof(kJournalMagic)) != 0 ||
+                header_->record_size != sizeof(JournalRecord)) {
+                close();
+                return false;
+            }
+            while (count < existing_records && records_[count].type != JournalRecordType::End) {
+                ++count;
+            }
+        } else if (!grow(config_.chunk_records)) {
+            close();
+            return false;
+        } else {
+            std::memcpy(header_->magic, kJournalMagic, sizeof(kJournalMagic));
+            header_->version = kJournalVersion;
+            header_->record_size = sizeof(JournalRecord);
+            header_->tick_size = config_.tick_size;
+            header_->durable_records = 0;
+        }
+
+        size_ = count;
+        written_.store(count, std::memory_order_relaxed);
+        flushed_ = count;
+        if (config_.flush_interval.count() > 0) {
+            stop_flusher_ = false;
+            flusher_ = std::thread([this] { flush_loop(); });
+        }
+        return true;
+    }
+
+    // Flushes everything and unmaps. Unused preallocated space stays zeroed in the file.
+    void close() {
+        if (flusher_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(flusher_mutex_);
+                stop_flusher_ = true;
+            }
+            flusher_cv_.notify_one();
+            flusher_.join();
+        }
+        if (base_ != nullptr) {
+            flush();
+            ::munmap(base_, map_bytes_);
+            base_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    bool is_open() const { return base_ != nullptr; }
+    size_t size() const { return size_; }
+    uint64_t failed_appends() const { return failed_appends_; }
+
+    // Writer thread. Returns false, and counts the failure, if the journal is full or the file
+    // could not grow.
+    bool append(const JournalRecord &record) {
+        if (size_ >= capacity_.load(std::memory_order_acquire) && !grow(size_ + 1)) {
+            ++failed_appends_;
+            return false;
+        }
+        JournalRecord &slot = records_[size_];
+        // Body first, type last, so a partially written record is never replayed
+        std::memcpy(reinterpret_cast<char*>(&slot) + 1, reinterpret_cast<const char*>(&record) + 1,
+                    sizeof(JournalRecord) - 1);
+        std::atomic_signal_fence(std::memory_order_release);
+        slot.type = record.type;
+        written_.store(++size_, std::memory_order_release);
+        return true;
+    }
+
+    bool append_add(const Order &order, TimeInForce time_in_force = TimeInForce::Day) {
+        return append({JournalRecordType::Add, order.is_buy, static_cast<uint8_t>(time_in_force), 0,
+                       order.owner_id, order.order_id, order.price, order.quantity, order.timestamp_ns});
+    }
+
+    bool append_cancel(uint64_t order_id) {
+        return append({JournalRecordType::Cancel, 0, 0, 0, 0, order_id, 0.0, 0, 0});
+    }
+
+    bool append_amend(uint64_t order_id, double new_price, uint64_t new_quantity) {
+        return append({JournalRecordType::Amend, 0, 0, 0, 0, order_id, new_price, new_quantity, 0});
+    }
+
+    bool append_auction(JournalRecordType type) {
+        return append({type, 0, 0, 0, 0, 0, 0.0, 0, 0});
+    }
+
+    // Any thread. Synchronously writes appended records to disk and records them as durable.
+    void flush() {
+        std::lock_guard<std::mutex> lock(flush_mutex_);
+        size_t written = written_.load(std::memory_order_acquire);
+        if (written == flushed_) {
+            return;
+        }
+        size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        size_t from = (sizeof(JournalHeader) + flushed_ * sizeof(JournalRecord)) / page * page;
+        size_t to = sizeof(JournalHeader) + written * sizeof(JournalRecord);
+        ::msync(base_ + from, to - from, MS_SYNC);
+        header_->durable_records = written;
+        ::msync(base_, page, MS_SYNC);
+        flushed_ = written;
+    }
+
+private:
+    // Extend the file to hold at least min_records, a chunk at a time
+    bool grow(size_t min_records) {
+        std::lock_guard<std::mutex> lock(grow_mutex_);
+        size_t capacity = capacity_.load(std::memory_order_relaxed);
+        if (capacity >= min_records) {
+            return true;
+        }
+        size_t target = (min_records + config_.chunk_records - 1) / config_.chunk_records * config_.chunk_records;
+        target = target < config_.max_records ? target : config_.max_records;
+        if (target < min_records) {
+            return false;
+        }
+        off_t bytes = static_cast<off_t>(sizeof(JournalHeader) + target * sizeof(JournalRecord));
+        off_t old_bytes = capacity > 0 ? static_cast<off_t>(sizeof(JournalHeader) + capacity * sizeof(JournalRecord)) : 0;
+#ifdef __linux__
+        // Allocate the new tail's blocks now, so a full disk fails here instead of raising
+        // SIGBUS on a mapped write. Filesystems without support get a sparse extension.
+        int reserved = ::posix_fallocate(fd_, old_bytes, bytes - old_bytes);
+        if (reserved != 0 && reserved != EINVAL && reserved != EOPNOTSUPP) {
+            ::ftruncate(fd_, old_bytes); // Drop any partial extension
+            return false;
+        }
+        if (reserved != 0 && ::ftruncate(fd_, bytes) != 0) {
+            return false;
+        }
+#else
+        if (::ftruncate(fd_, bytes) != 0) {
+            return false;
+        }
+#endif
+        size_t from = sizeof(JournalHeader) + capacity * sizeof(JournalRecord);
+        size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        from = from / page * page;
+        ::madvise(base_ + from, static_cast<size_t>(bytes) - from, MADV_WILLNEED);
+        capacity_.store(target, std::memory_order_release);
+        return true;
+    }
+
+    void flush_loop() {
+        std::unique_lock<std::mutex> lock(flusher_mutex_);
+        while (!stop_flusher_) {
+            flusher_cv_.wait_for(lock, config_.flush_interval);
+            lock.unlock();
+            flush();
+            // Keep at least half a chunk of preallocated space ahead of the writer
+            size_t written = written_.load(std::memory_order_acquire);
+            if (written + config_.chunk_records / 2 >= capacity_.load(std::memory_order_acquire)) {
+                grow(written + config_.chunk_records);
+            }
+            lock.lock();
+        }
+    }
+
+    JournalConfig config_;
+    int fd_ = -1;
+    char *base_ = nullptr;
+    size_t map_bytes_ = 0;
+    JournalHeader *header_ = nullptr;
+    JournalRecord *records_ = nullptr;
+    size_t size_ = 0;                  // Writer thread only
+    uint64_t failed_appends_ = 0;      // Writer thread only
+    std::atomic<size_t> written_{0};   // Published size_ for the flusher
+    std::atomic<size_t> capacity_{0};  // Records the file currently holds
+    size_t flushed_ = 0;               // Guarded by flush_mutex_
+    std::mutex flush_mutex_;
+    std::mutex grow_mutex_;
+    std::thread flusher_;
+    std::mutex flusher_mutex_;
+    std::condition_variable flusher_cv_;
+    bool stop_flusher_ = false;
+};
+
+// Read-only view of a journal for recovery
+class JournalReader {
+public:
+    JournalReader() = default;
+    ~JournalReader() { close(); }
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    bool open(const std::string &path) {
+        close();
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(JournalHeader))) {
+            close();
+            return false;
+        }
+        map_bytes_ = static_cast<size_t>(st.st_size);
+        void *map = ::mmap(nullptr, map_bytes_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (map == MAP_FAILED) {
+            close();
+            return false;
+        }
+        base_ = static_cast<const char*>(map);
+        ::madvise(const_cast<char*>(base_), map_bytes_, MADV_SEQUENTIAL);
+        const JournalHeader *header = reinterpret_cast<const JournalHeader*>(base_);
+        if (std::memcmp(header->magic, kJournalMagic, sizeof(kJournalMagic)) != 0 ||
+            header->record_size != sizeof(JournalRecord)) {
+            close();
+            return false;
+        }
+        records_ = reinterpret_cast<const JournalRecord*>(base_ + sizeof(JournalHeader));
+        capacity_ = (map_bytes_ - sizeof(JournalHeader)) / sizeof(JournalRecord);
+        return true;
+    }
+
+    void close() {
+        if (base_ != nullptr) {
+            ::munmap(const_cast<char*>(base_), map_bytes_);
+            base_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    bool is_open() const { return base_ != nullptr; }
+    const JournalHeader& header() const { return *reinterpret_cast<const JournalHeader*>(base_); }
+
+    // Visit records in order from record from up to the first unwritten slot; returns the
+    // number visited.
+    template<typename Fn>
+    size_t for_each(Fn &&fn, size_t from = 0) const {
+        size_t i = from;
+        for (; i < capacity_ && records_[i].type != JournalRecordType::End; ++i) {
+            fn(records_[i]);
+        }
+        return i > from ? i - from : 0;
+    }
+
+    // Re-apply records from record from on to book, which must not be journaling. Start from 0
+    // on an empty book, or from CheckpointInfo::journal_records after loading a checkpoint.
+    template<typename Book>
+    size_t replay(Book &book, size_t from = 0) const {
+        return for_each([&book](const JournalRecord &record) {
+            switch (record.type) {
+                case JournalRecordType::Add: {
+                    Order order{record.order_id, record.is_buy != 0, record.price, record.quantity,
+                                record.timestamp_ns, record.owner_id};
+                    if (record.time_in_force == static_cast<uint8_t>(TimeInForce::Day)) {
+                        book.add_order(order);
+                    } else {
+                        book.add_order(order, static_cast<TimeInForce>(record.time_in_force));
+                    }
+                    break;
+                }
+                case JournalRecordType::Cancel:
+                    book.cancel_order(record.order_id);
+                    break;
+                case JournalRecordType::Amend:
+                    book.amend_order(record.order_id, record.price, record.quantity);
+                    break;
+                case JournalRecordType::BeginAuction:
+                    book.begin_auction();
+                    break;
+                case JournalRecordType::Uncross:
+                    book.uncross();
+                    break;
+                case JournalRecordType::End:
+                    break;
+            }
+        }, from);
+    }
+
+private:
+    int fd_ = -1;
+    const char *base_ = nullptr;
+    size_t map_bytes_ = 0;
+    const JournalRecord *records_ = nullptr;
+    size_t capacity_ = 0;
+};
+
+} // namespace OrderBookSystem
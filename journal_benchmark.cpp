@@ -0,0 +1,183 @@
+#include "order_book.h"
+#include "journal.h"
+#include "workload.h"
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+
+using namespace OrderBookSystem;
+
+// Journaling overhead, journal recovery time, and checkpoint save/restore time. The workload is
+// generated in chunks (a 50M-op stream does not fit in memory comfortably) and only the book
+// calls are timed.
+
+struct Options {
+    bool hft = true;
+    size_t events = 50000000;
+    uint64_t seed = 42;
+    std::string path = "orderbook_benchmark.journal"; // The checkpoint goes to path + ".checkpoint"
+    bool keep = false; // Keep the journal file afterwards
+    size_t checkpoint_orders = 5000000;
+    LevelStorage storage = LevelStorage::Map;
+    OrderIndexPolicy index = OrderIndexPolicy::Hash;
+};
+
+const size_t kChunk = 1000000;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Applies the workload to book; returns seconds spent inside the book
+double run_workload(const Options &options, OrderBook &book) {
+    WorkloadGenerator generator(options.hft ? hft_workload(options.seed) : uniform_workload(options.seed));
+    double seconds = 0.0;
+    for (size_t done = 0; done < options.events; done += kChunk) {
+        std::vector<WorkloadOp> ops = generator.generate(std::min(kChunk, options.events - done));
+        auto start = std::chrono::steady_clock::now();
+        for (const WorkloadOp &op : ops) {
+            apply_op(book, op);
+        }
+        seconds += seconds_since(start);
+    }
+    return seconds;
+}
+
+Options parse_options(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--workload") {
+            options.hft = std::strcmp(value, "uniform") != 0;
+        } else if (arg == "--events") {
+            options.events = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--path") {
+            options.path = value;
+        } else if (arg == "--checkpoint-orders") {
+            options.checkpoint_orders = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--storage") {
+            options.storage = std::strcmp(value, "ladder") == 0 ? LevelStorage::Ladder : LevelStorage::Map;
+        } else if (arg == "--index") {
+            options.index = std::strcmp(value, "slab") == 0 ? OrderIndexPolicy::Slab : OrderIndexPolicy::Hash;
+        } else if (arg == "--keep") {
+            options.keep = true;
+            continue;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--workload uniform|hft] [--events N] [--seed N]"
+                      << " [--path FILE] [--keep] [--checkpoint-orders N] [--storage map|ladder] [--index hash|slab]"
+                      << std::endl;
+            std::exit(1);
+        }
+        ++i;
+    }
+    return options;
+}
+
+// Save and restore a book of checkpoint_orders resting orders spread over 2000 levels per side
+void run_checkpoint_benchmark(const Options &options, const OrderBookConfig &config) {
+    std::string path = options.path + ".checkpoint";
+    OrderBookConfig large = config;
+    large.expected_orders = options.checkpoint_orders;
+    OrderBook book(large);
+    for (uint64_t i = 0; i < options.checkpoint_orders; ++i) {
+        bool is_buy = (i & 1) != 0;
+        double offset = static_cast<double>((i / 2) % 2000) * 0.01;
+        book.add_order({i + 1, is_buy, is_buy ? 99.99 - offset : 100.00 + offset, 1 + i % 100, i});
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool saved = book.save_checkpoint(path);
+    double save_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    CheckpointInfo info;
+    bool loaded = OrderBook::read_checkpoint_info(path, info);
+    OrderBook restored(info.config);
+    loaded = loaded && restored.load_checkpoint(path);
+    double load_seconds = seconds_since(start);
+
+    std::cout << "Checkpoint:        " << options.checkpoint_orders << " orders, save " << save_seconds * 1e3
+              << " ms, restore " << load_seconds * 1e3 << " ms ("
+              << (saved && loaded && restored.order_count() == book.order_count() ? "verified" : "FAILED") << ")\n";
+    if (!options.keep) {
+        std::remove(path.c_str());
+    }
+}
+
+int main(int argc, char **argv) {
+    Options options = parse_options(argc, argv);
+    OrderBookConfig config(false, 10, 0.01);
+    config.level_storage = options.storage;
+    config.order_index = options.index;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "--- Journal (" << options.events << " commands, " << (options.hft ? "hft" : "uniform")
+              << " workload) ---\n";
+
+    double plain_seconds;
+    {
+        OrderBook book(config);
+        plain_seconds = run_workload(options, book);
+    }
+
+    std::remove(options.path.c_str());
+    double journaled_seconds, close_seconds;
+    size_t records;
+    {
+        JournalWriter journal;
+        if (!journal.open(options.path)) {
+            std::cerr << "Cannot open " << options.path << std::endl;
+            return 1;
+        }
+        OrderBook book(config);
+        book.set_journal(&journal);
+        journaled_seconds = run_workload(options, book);
+        records = journal.size();
+        auto start = std::chrono::steady_clock::now();
+        journal.close();
+        close_seconds = seconds_since(start);
+    }
+
+    std::cout << "Without journal:   " << plain_seconds * 1e9 / options.events << " ns/command\n";
+    std::cout << "With journal:      " << journaled_seconds * 1e9 / options.events << " ns/command ("
+              << (journaled_seconds - plain_seconds) * 1e9 / options.events << " ns overhead)\n";
+    std::cout << "Journaled records: " << records << " (" << records * sizeof(JournalRecord) / (1024.0 * 1024.0)
+              << " MiB); final flush " << close_seconds * 1e3 << " ms\n";
+
+    // Recovery: map the file, then scan alone and rebuild a book from it
+    auto start = std::chrono::steady_clock::now();
+    JournalReader reader;
+    if (!reader.open(options.path)) {
+        std::cerr << "Cannot read " << options.path << std::endl;
+        return 1;
+    }
+    uint64_t checksum = 0;
+    size_t scanned = reader.for_each([&checksum](const JournalRecord &record) { checksum += record.quantity; });
+    double scan_seconds = seconds_since(start);
+
+    start = std::chrono::steady_clock::now();
+    OrderBook recovered(config);
+    size_t replayed = reader.replay(recovered);
+    double replay_seconds = seconds_since(start);
+
+    std::cout << "Scan:              " << scanned / scan_seconds / 1e6 << " M records/sec ("
+              << scan_seconds * 1e3 << " ms, checksum " << checksum << ")\n";
+    std::cout << "Replay:            " << replayed / replay_seconds / 1e6 << " M events/sec ("
+              << replay_seconds * 1e3 << " ms to rebuild the book)\n";
+
+    reader.close();
+    if (!options.keep) {
+        std::remove(options.path.c_str());
+    }
+
+    run_checkpoint_benchmark(options, config);
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include "order_book.h"
+#include "latency_histogram.h"
+#include "workload.h"
+#include "thread_affinity.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+using namespace OrderBookSystem;
+
+// Latency categories reported separately
+enum Category { kAddPassive, kAddAggressive, kCancel, kAmend, kCategoryCount };
+const char* kCategoryNames[kCategoryCount] = {"add_passive", "add_aggressive", "cancel", "amend"};
+
+struct Options {
+    LevelStorage storage = LevelStorage::Map;
+    OrderIndexPolicy index = OrderIndexPolicy::Hash;
+    size_t ops = 2000000;
+    size_t warmup = 200000;
+    int cpu = 0;             // -1 disables pinning
+    uint64_t seed = 42;
+    bool hft = false;        // Workload: uniform (default) or hft
+    size_t reserve = 65536;  // expected_orders: order index and node pool sized up front
+    bool huge_pages = false; // Node pool on 2MB pages
+    bool prefault = false;   // Node pool pages touched before the run
+    std::string json_path;   // Empty: print JSON to stdout
+};
+
+// Counts trades so an add can be classified as aggressive (it traded) or passive
+class TradeCounter : public ExecutionListener {
+public:
+    uint64_t trades = 0;
+    void on_execution(const ExecutionReport &report) override {
+        trades += (report.type == ExecutionType::Trade);
+    }
+};
+
+std::string to_json(const Options &options, bool pinned, double ticks_per_ns, double overhead_ns,
+                    double ops_per_sec, const MemoryPoolStats &pool,
+                    const LatencyHistogram (&histograms)[kCategoryCount]) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "{\n  \"config\": {"
+        << "\"workload\": \"" << (options.hft ? "hft" : "uniform") << "\", "
+        << "\"level_storage\": \"" << (options.storage == LevelStorage::Map ? "map" : "ladder") << "\", "
+        << "\"order_index\": \"" << (options.index == OrderIndexPolicy::Hash ? "hash" : "slab") << "\", "
+        << "\"ops\": " << options.ops << ", \"warmup\": " << options.warmup << ", "
+        << "\"seed\": " << options.seed << ", \"cpu\": " << options.cpu << ", "
+        << "\"pinned\": " << (pinned ? "true" : "false") << ", "
+        << "\"ticks_per_ns\": " << ticks_per_ns << ", \"timer_overhead_ns\": " << overhead_ns << ", "
+        << "\"reserve\": " << options.reserve << ", \"huge_pages\": " << (options.huge_pages ? "true" : "false")
+        << ", \"prefault\": " << (options.prefault ? "true" : "false") << "},\n"
+        << "  \"node_pool\": {\"peak\": " << pool.peak << ", \"capacity\": " << pool.capacity
+        << ", \"chunks\": " << pool.chunks << ", \"bytes\": " << pool.bytes
+        << ", \"explicit_huge_pages\": " << (pool.huge_pages ? "true" : "false") << "},\n"
+        << "  \"throughput_ops_per_sec\": " << ops_per_sec << ",\n  \"latency_ns\": {\n";
+    for (int c = 0; c < kCategoryCount; ++c) {
+        const LatencyHistogram &h = histograms[c];
+        out << "    \"" << kCategoryNames[c] << "\": {\"count\": " << h.count()
+            << ", \"mean\": " << h.mean() / ticks_per_ns
+            << ", \"p50\": " << h.percentile(50.0) / ticks_per_ns
+            << ", \"p90\": " << h.percentile(90.0) / ticks_per_ns
+            << ", \"p99\": " << h.percentile(99.0) / ticks_per_ns
+            << ", \"p99.9\": " << h.percentile(99.9) / ticks_per_ns
+            << ", \"max\": " << h.max() / ticks_per_ns << "}"
+            << (c + 1 < kCategoryCount ? ",\n" : "\n");
+    }
+    out << "  }\n}\n";
+    return out.str();
+}
+
+Options parse_options(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--storage") {
+            options.storage = std::strcmp(value, "ladder") == 0 ? LevelStorage::Ladder : LevelStorage::Map;
+        } else if (arg == "--index") {
+            options.index = std::strcmp(value, "slab") == 0 ? OrderIndexPolicy::Slab : OrderIndexPolicy::Hash;
+        } else if (arg == "--ops") {
+            options.ops = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--warmup") {
+            options.warmup = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--cpu") {
+            options.cpu = std::atoi(value);
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--workload") {
+            options.hft = std::strcmp(value, "hft") == 0;
+        } else if (arg == "--json") {
+            options.json_path = value;
+        } else if (arg == "--reserve") {
+            options.reserve = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--huge-pages") {
+            options.huge_pages = true;
+            continue;
+        } else if (arg == "--prefault") {
+            options.prefault = true;
+            continue;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--storage map|ladder] [--index hash|slab] [--workload uniform|hft]"
+                      << " [--ops N] [--warmup N] [--cpu N|-1] [--seed N] [--json FILE]"
+                      << " [--reserve N] [--huge-pages] [--prefault]" << std::endl;
+            std::exit(1);
+        }
+        ++i;
+    }
+    return options;
+}
+
+int main(int argc, char **argv) {
+    Options options = parse_options(argc, argv);
+    bool pinned = pin_current_thread(options.cpu);
+
+    // Everything that is not the book itself happens before timing starts
+    WorkloadConfig workload = options.hft ? hft_workload(options.seed) : uniform_workload(options.seed);
+    std::vector<WorkloadOp> ops = WorkloadGenerator(workload).generate(options.warmup + options.ops);
+    double ticks_per_ns = TscClock::calibrate();
+    double overhead_ns = TscClock::overhead_ticks() / ticks_per_ns;
+
+    OrderBookConfig config(false, 10, 0.01);
+    config.level_storage = options.storage;
+    config.order_index = options.index;
+    config.expected_orders = options.reserve;
+    config.pool_huge_pages = options.huge_pages;
+    config.pool_prefault = options.prefault;
+    OrderBook book(config);
+    TradeCounter trades;
+    book.set_execution_listener(&trades);
+
+    for (size_t i = 0; i < options.warmup; ++i) {
+        apply_op(book, ops[i]);
+    }
+
+    LatencyHistogram histograms[kCategoryCount];
+    uint64_t run_start = TscClock::start();
+    for (size_t i = options.warmup; i < ops.size(); ++i) {
+        const WorkloadOp &op = ops[i];
+        uint64_t trades_before = trades.trades;
+
+        uint64_t t0 = TscClock::start();
+        apply_op(book, op);
+        uint64_t t1 = TscClock::stop();
+
+        Category category;
+        if (op.type == OpType::Add) {
+            category = (trades.trades != trades_before) ? kAddAggressive : kAddPassive;
+        } else {
+            category = (op.type == OpType::Cancel) ? kCancel : kAmend;
+        }
+        histograms[category].record(t1 - t0);
+    }
+    uint64_t run_end = TscClock::stop();
+    double ops_per_sec = options.ops / ((run_end - run_start) / ticks_per_ns / 1e9);
+
+    std::cout << "--- Per-Operation Latency (ns, includes ~" << std::fixed << std::setprecision(1)
+              << overhead_ns << " ns timer overhead; " << (pinned ? "pinned" : "not pinned") << ") ---\n";
+    std::cout << std::setw(16) << std::left << "operation" << std::right
+              << std::setw(10) << "count" << std::setw(9) << "mean" << std::setw(9) << "p50"
+              << std::setw(9) << "p90" << std::setw(9) << "p99" << std::setw(9) << "p99.9"
+              << std::setw(11) << "max" << std::endl;
+    for (int c = 0; c < kCategoryCount; ++c) {
+        const LatencyHistogram &h = histograms[c];
+        std::cout << std::setw(16) << std::left << kCategoryNames[c] << std::right << std::setprecision(0)
+                  << std::setw(10) << h.count() << std::setw(9) << h.mean() / ticks_per_ns
+                  << std::setw(9) << h.percentile(50.0) / ticks_per_ns
+                  << std::setw(9) << h.percentile(90.0) / ticks_per_ns
+                  << std::setw(9) << h.percentile(99.0) / ticks_per_ns
+                  << std::setw(9) << h.percentile(99.9) / ticks_per_ns
+                  << std::setw(11) << h.max() / ticks_per_ns << std::endl;
+    }
+    std::cout << "Throughput: " << std::setprecision(0) << ops_per_sec << " ops/sec" << std::endl;
+    MemoryPoolStats pool = book.memory_pool_stats();
+    std::cout << "Node pool: peak " << pool.peak << " of " << pool.capacity << " slots, " << pool.chunks
+              << " chunk(s), " << pool.bytes / (1 << 20) << " MiB"
+              << (pool.huge_pages ? ", explicit huge pages" : "") << std::endl;
+
+    std::string json = to_json(options, pinned, ticks_per_ns, overhead_ns, ops_per_sec, pool, histograms);
+    if (options.json_path.empty()) {
+        std::cout << json;
+    } else {
+        std::ofstream(options.json_path) << json;
+        std::cout << "Wrote " << options.json_path << std::endl;
+    }
+    return 0;
+}
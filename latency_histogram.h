@@ -0,0 +1,180 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace OrderBookSystem {
+
+// Low-overhead timestamp source for benchmarks: the TSC on x86, steady_clock elsewhere.
+// Timestamps are in ticks; calibrate() measures ticks per nanosecond once, outside timed loops.
+class TscClock {
+public:
+    // Start of a timed region: fence so earlier work is not timed.
+    static inline uint64_t start() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_lfence();
+        uint64_t t = __rdtsc();
+        _mm_lfence();
+        return t;
+#else
+        return now_ns();
+#endif
+    }
+
+    // End of a timed region: rdtscp waits for the timed work to finish.
+    static inline uint64_t stop() {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned aux;
+        uint64_t t = __rdtscp(&aux);
+        _mm_lfence();
+        return t;
+#else
+        return now_ns();
+#endif
+    }
+
+    // Ticks per nanosecond, measured against steady_clock over the given interval.
+    static double calibrate(std::chrono::milliseconds interval = std::chrono::milliseconds(100)) {
+#if defined(__x86_64__) || defined(__i386__)
+        uint64_t ns0 = now_ns();
+        uint64_t t0 = start();
+        while (now_ns() - ns0 < static_cast<uint64_t>(interval.count()) * 1000000) {
+        }
+        uint64_t t1 = stop();
+        uint64_t ns1 = now_ns();
+        return static_cast<double>(t1 - t0) / static_cast<double>(ns1 - ns0);
+#else
+        (void)interval;
+        return 1.0;
+#endif
+    }
+
+    // Smallest start()/stop() delta: the fixed cost included in every sample.
+    static uint64_t overhead_ticks(int samples = 10000) {
+        uint64_t best = UINT64_MAX;
+        for (int i = 0; i < samples; ++i) {
+            uint64_t t0 = start();
+            uint64_t t1 = stop();
+            best = (t1 - t0) < best ? (t1 - t0) : best;
+        }
+        return best;
+    }
+
+private:
+    static uint64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+// HDR-style log-linear histogram of non-negative integer samples.
+// Values below kSubBucketCount are counted exactly; above that, each power-of-two range is split
+// into kSubBucketCount / 2 linear sub-buckets, so any value is reported within 1/128 (< 0.8%). Recording is a bit scan and an
+// increment into a fixed array; nothing allocates after construction.
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 8;
+    static constexpr uint64_t kSubBucketCount = uint64_t(1) << kSubBucketBits;
+
+    LatencyHistogram() : counts_((64 - kSubBucketBits + 2) * (kSubBucketCount / 2), 0), total_(0), max_(0) {}
+
+    void record(uint64_t value) {
+        ++counts_[index_of(value)];
+        ++total_;
+        max_ = value > max_ ? value : max_;
+    }
+
+    void merge(const LatencyHistogram &other) {
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        max_ = other.max_ > max_ ? other.max_ : max_;
+    }
+
+    void reset() {
+        counts_.assign(counts_.size(), 0);
+        total_ = 0;
+        max_ = 0;
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t max() const { return max_; }
+
+    double mean() const {
+        if (total_ == 0) {
+            return 0.0;
+        }
+        double sum = 0.0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            if (counts_[i] != 0) {
+                sum += static_cast<double>(counts_[i]) * midpoint_of(i);
+            }
+        }
+        return sum / static_cast<double>(total_);
+    }
+
+    // Value at the given percentile (0-100), as the upper bound of its sub-bucket.
+    uint64_t percentile(double pct) const {
+        if (total_ == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(pct / 100.0 * static_cast<double>(total_) + 0.5);
+        rank = rank == 0 ? 1 : rank;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                uint64_t upper = highest_of(i);
+                return upper < max_ ? upper : max_;
+            }
+        }
+        return max_;
+    }
+
+private:
+    static size_t index_of(uint64_t value) {
+        if (value < kSubBucketCount) {
+            return static_cast<size_t>(value);
+        }
+        unsigned msb = 63 - __builtin_clzll(value);
+        unsigned shift = msb - kSubBucketBits + 1;
+        uint64_t sub = value >> shift; // In [kSubBucketCount / 2, kSubBucketCount)
+        return static_cast<size_t>(shift - 1) * (kSubBucketCount / 2) + static_cast<size_t>(sub) + kSubBucketCount / 2;
+    }
+
+    static size_t shift_of(size_t index) {
+        return (index - kSubBucketCount) / (kSubBucketCount / 2) + 1;
+    }
+
+    static uint64_t lowest_of(size_t index) {
+        if (index < kSubBucketCount) {
+            return index;
+        }
+        size_t shift = shift_of(index);
+        uint64_t sub = index - kSubBucketCount - (shift - 1) * (kSubBucketCount / 2) + kSubBucketCount / 2;
+        return sub << shift;
+    }
+
+    static uint64_t highest_of(size_t index) {
+        if (index < kSubBucketCount) {
+            return index;
+        }
+        return lowest_of(index) + (uint64_t(1) << shift_of(index)) - 1;
+    }
+
+    static double midpoint_of(size_t index) {
+        return (static_cast<double>(lowest_of(index)) + static_cast<double>(highest_of(index))) / 2.0;
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_;
+    uint64_t max_;
+};
+
+} // namespace OrderBookSystem
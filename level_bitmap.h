@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OrderBookSystem {
+
+// Hierarchical occupancy bitmap over ladder slots.
+// Layer 0 has one bit per slot; each bit of layer n + 1 says whether the corresponding 64-bit
+// word of layer n is non-zero. Finding the next occupied slot in either direction touches one
+// word per layer (three layers cover 262,144 slots) using count-trailing/leading-zero instructions.
+class LevelBitmap {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit LevelBitmap(size_t size = 0) { reset(size); }
+
+    // Clear every bit and resize to cover size slots.
+    void reset(size_t size) {
+        layers_.clear();
+        size_t bits = size > 0 ? size : 1;
+        do {
+            size_t words = (bits + 63) / 64;
+            layers_.emplace_back(words, 0);
+            bits = words;
+        } while (bits > 1);
+    }
+
+    void set(size_t pos) {
+        for (auto &layer : layers_) {
+            uint64_t &word = layer[pos >> 6];
+            bool was_empty = (word == 0);
+            word |= uint64_t(1) << (pos & 63);
+            if (!was_empty) {
+                break; // Upper layers already mark this word as occupied
+            }
+            pos >>= 6;
+        }
+    }
+
+    void clear(size_t pos) {
+        for (auto &layer : layers_) {
+            uint64_t &word = layer[pos >> 6];
+            word &= ~(uint64_t(1) << (pos & 63));
+            if (word != 0) {
+                break; // Word still occupied, upper layers unchanged
+            }
+            pos >>= 6;
+        }
+    }
+
+    bool test(size_t pos) const {
+        return (layers_[0][pos >> 6] >> (pos & 63)) & 1;
+    }
+
+    // First set bit at or above pos, or npos.
+    size_t next_set(size_t pos) const {
+        size_t layer = 0;
+        size_t idx = pos;
+        while (true) {
+            if (layer == layers_.size()) {
+                return npos;
+            }
+            size_t word_idx = idx >> 6;
+            if (word_idx >= layers_[layer].size()) {
+                return npos;
+            }
+            uint64_t bits = layers_[layer][word_idx] & (~uint64_t(0) << (idx & 63));
+            if (bits != 0) {
+                idx = (word_idx << 6) + __builtin_ctzll(bits);
+                break;
+            }
+            idx = word_idx + 1; // Continue from the next word, one layer up
+            ++layer;
+        }
+        while (layer > 0) {
+            --layer;
+            idx = (idx << 6) + __builtin_ctzll(layers_[layer][idx]);
+        }
+        return idx;
+    }
+
+    // Last set bit at or below pos, or npos.
+    size_t prev_set(size_t pos) const {
+        size_t layer = 0;
+        size_t idx = pos;
+        while (true) {
+            if (layer == layers_.size()) {
+                return npos;
+            }
+            size_t word_idx = idx >> 6;
+            uint64_t bits = layers_[layer][word_idx] & (~uint64_t(0) >> (63 - (idx & 63)));
+            if (bits != 0) {
+                idx = (word_idx << 6) + 63 - __builtin_clzll(bits);
+                break;
+            }
+            if (word_idx == 0) {
+                return npos;
+            }
+            idx = word_idx - 1; // Continue from the previous word, one layer up
+            ++layer;
+        }
+        while (layer > 0) {
+            --layer;
+            idx = (idx << 6) + 63 - __builtin_clzll(layers_[layer][idx]);
+        }
+        return idx;
+    }
+
+private:
+    std::vector<std::vector<uint64_t>> layers_; // layers_[0] is the per-slot layer
+};
+
+} // namespace OrderBookSystem
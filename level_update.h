@@ -0,0 +1,76 @@
+#pragma once
+
+#include "common.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OrderBookSystem {
+
+// Kind of change to one of the top price levels on a side
+enum class LevelUpdateType : uint8_t {
+    New,    // Insert at level; deeper levels move down one and anything past depth drops off
+    Change, // The level's quantity changed
+    Delete  // Remove level; deeper levels move up one
+};
+
+// Incremental market-by-price update. level is the 0-based position from the best price at
+// the time the update applies. When a Delete opens a slot at the bottom of a full view, the
+// level that moves into view follows as a New at depth - 1.
+struct LevelUpdate {
+    LevelUpdateType type;
+    bool is_buy;
+    uint32_t level;
+    double price;
+    uint64_t quantity; // Total quantity at the level after the update (0 for Delete)
+};
+
+// Receives level updates synchronously from the matching thread. Must not block.
+class LevelUpdateListener {
+public:
+    virtual ~LevelUpdateListener() = default;
+    virtual void on_level_update(const LevelUpdate &update) = 0;
+};
+
+// Consumer-side copy of the top levels kept in sync from LevelUpdates alone.
+class L2MirrorBook : public LevelUpdateListener {
+public:
+    explicit L2MirrorBook(size_t depth) : depth_(depth) {
+        bids_.reserve(depth + 1);
+        asks_.reserve(depth + 1);
+    }
+
+    void on_level_update(const LevelUpdate &update) override {
+        std::vector<PriceLevel> &side = update.is_buy ? bids_ : asks_;
+        switch (update.type) {
+            case LevelUpdateType::New:
+                side.insert(side.begin() + update.level, PriceLevel{update.price, update.quantity});
+                if (side.size() > depth_) {
+                    side.pop_back();
+                }
+                break;
+            case LevelUpdateType::Change:
+                side[update.level].total_quantity = update.quantity;
+                break;
+            case LevelUpdateType::Delete:
+                side.erase(side.begin() + update.level);
+                break;
+        }
+    }
+
+    size_t depth() const { return depth_; }
+    const std::vector<PriceLevel>& bids() const { return bids_; }
+    const std::vector<PriceLevel>& asks() const { return asks_; }
+
+    void clear() {
+        bids_.clear();
+        asks_.clear();
+    }
+
+private:
+    size_t depth_;
+    std::vector<PriceLevel> bids_;
+    std::vector<PriceLevel> asks_;
+};
+
+} // namespace OrderBookSystem
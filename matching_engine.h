@@ -0,0 +1,213 @@
+#pragma once
+
+#include "order_book.h"
+#include "spsc_queue.h"
+#include "thread_affinity.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace OrderBookSystem {
+
+// One request for the matching thread. Cancels use order.order_id only; amends carry the new
+// price and quantity.
+struct EngineCommand {
+    CommandType type;
+    uint32_t book;     // Index of the target book within the engine
+    uint64_t sequence; // Assigned by MatchingEngine::submit
+    Order order;
+};
+
+// Output of the matching thread: the execution reports a command produced, followed by
+// exactly one Ack carrying the command's sequence and whether the book accepted it.
+struct EngineEvent {
+    enum class Kind : uint8_t { Execution, Ack };
+    Kind kind;
+    bool accepted;     // Ack only: false if a cancel or amend did not find its order, or the book does not exist
+    uint32_t book;     // Book the command targeted
+    uint64_t sequence; // Command that produced this event
+    ExecutionReport report; // Execution only
+};
+
+struct MatchingEngineConfig {
+    OrderBookConfig book;
+    size_t num_books = 1; // Independent books (e.g. instruments) served by this thread
+    size_t command_capacity = 65536;
+    size_t event_capacity = 262144;
+    int cpu = -1; // Pin the matching thread to this CPU (-1: no pinning)
+    std::vector<TopOfBook*> top_of_books; // Optional, indexed by book; attached by the matching thread
+};
+
+// Runs one or more OrderBooks on a dedicated thread. One producer thread submits commands
+// through a lock-free SPSC ring; the matching thread applies them in order and publishes
+// execution reports and acks on a second SPSC ring, which one consumer thread drains with
+// poll(). If the event ring fills, the matching thread waits for the consumer, so a consumer
+// that stops polling eventually stalls submission as well.
+// The books are constructed by the matching thread after it is pinned, so their memory pools
+// are first touched on (and stay local to) that core.
+class MatchingEngine : private ExecutionListener {
+public:
+    explicit MatchingEngine(const MatchingEngineConfig &config = MatchingEngineConfig())
+        : config_(config), commands_(config.command_capacity), events_(config.event_capacity),
+          running_(false), ready_(false), pinned_(false), next_sequence_(1),
+          current_book_(0), current_sequence_(0) {}
+
+    ~MatchingEngine() { stop(); }
+
+    MatchingEngine(const MatchingEngine&) = delete;
+    MatchingEngine& operator=(const MatchingEngine&) = delete;
+
+    void start() {
+        if (running_.exchange(true)) {
+            return;
+        }
+        thread_ = std::thread([this] { run(); });
+        SpinWait backoff;
+        while (!ready_.load(std::memory_order_acquire)) {
+            backoff.wait();
+        }
+    }
+
+    // Applies every command already submitted, then joins the matching thread. Events still
+    // in the ring stay available to poll().
+    void stop() {
+        if (!running_.exchange(false)) {
+            return;
+        }
+        thread_.join();
+    }
+
+    bool running() const { return running_.load(std::memory_order_relaxed); }
+    bool pinned() const { return pinned_.load(std::memory_order_relaxed); }
+
+    // Producer side. Returns the command's sequence number, or 0 if the ring is full.
+    uint64_t try_submit(CommandType type, const Order &order, uint32_t book = 0) {
+        EngineCommand command{type, book, next_sequence_, order};
+        if (!commands_.try_push(command)) {
+            return 0;
+        }
+        return next_sequence_++;
+    }
+
+    // Producer side. Spins until there is room in the command ring.
+    uint64_t submit(CommandType type, const Order &order, uint32_t book = 0) {
+        SpinWait backoff;
+        uint64_t sequence;
+        while ((sequence = try_submit(type, order, book)) == 0) {
+            backoff.wait();
+        }
+        return sequence;
+    }
+
+    uint64_t add_order(const Order &order, uint32_t book = 0) { return submit(CommandType::Add, order, book); }
+
+    uint64_t cancel_order(uint64_t order_id, uint32_t book = 0) {
+        return submit(CommandType::Cancel, {order_id, false, 0.0, 0, 0}, book);
+    }
+
+    uint64_t amend_order(uint64_t order_id, double new_price, uint64_t new_quantity, uint32_t book = 0) {
+        return submit(CommandType::Amend, {order_id, false, new_price, new_quantity, 0}, book);
+    }
+
+    // Consumer side. Returns false if no event is ready.
+    bool poll(EngineEvent &event) { return events_.try_pop(event); }
+
+    size_t book_count() const { return config_.num_books; }
+
+    // Exists once the engine has been started; only safe to use while it is stopped.
+    OrderBook& book(size_t index = 0) { return *books_[index]; }
+    const OrderBook& book(size_t index = 0) const { return *books_[index]; }
+
+private:
+    void run() {
+        pinned_.store(pin_current_thread(config_.cpu), std::memory_order_relaxed);
+        if (books_.empty()) {
+            for (size_t i = 0; i < config_.num_books; ++i) {
+                books_.emplace_back(new OrderBook(config_.book));
+                books_.back()->set_execution_listener(this);
+                if (i < config_.top_of_books.size() && config_.top_of_books[i] != nullptr) {
+                    books_.back()->set_top_of_book(config_.top_of_books[i]);
+                }
+            }
+        }
+        ready_.store(true, std::memory_order_release);
+        SpinWait idle;
+        EngineCommand command;
+        while (true) {
+            if (commands_.try_pop(command)) {
+                execute(command);
+                idle.reset();
+            } else if (!running_.load(std::memory_order_acquire)) {
+                // Drain anything pushed before stop() was observed
+                if (!commands_.try_pop(command)) {
+                    break;
+                }
+                execute(command);
+            } else {
+                idle.wait();
+            }
+        }
+    }
+
+    void execute(const EngineCommand &command) {
+        current_book_ = command.book;
+        current_sequence_ = command.sequence;
+        bool accepted = false;
+        if (command.book < books_.size()) {
+            OrderBook &book = *books_[command.book];
+            switch (command.type) {
+                case CommandType::Add:
+                    book.add_order(command.order);
+                    accepted = true;
+                    break;
+                case CommandType::Cancel:
+                    accepted = book.cancel_order(command.order.order_id);
+                    break;
+                case CommandType::Amend:
+                    accepted = book.amend_order(command.order.order_id, command.order.price, command.order.quantity);
+                    break;
+            }
+        }
+        EngineEvent ack;
+        ack.kind = EngineEvent::Kind::Ack;
+        ack.accepted = accepted;
+        ack.book = command.book;
+        ack.sequence = command.sequence;
+        ack.report = ExecutionReport();
+        publish(ack);
+    }
+
+    void on_execution(const ExecutionReport &report) override {
+        EngineEvent event;
+        event.kind = EngineEvent::Kind::Execution;
+        event.accepted = true;
+        event.book = current_book_;
+        event.sequence = current_sequence_;
+        event.report = report;
+        publish(event);
+    }
+
+    void publish(const EngineEvent &event) {
+        SpinWait backoff;
+        while (!events_.try_push(event)) {
+            backoff.wait();
+        }
+    }
+
+    MatchingEngineConfig config_;
+    std::vector<std::unique_ptr<OrderBook>> books_; // Built and used by the matching thread
+    SpscQueue<EngineCommand> commands_;
+    SpscQueue<EngineEvent> events_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> ready_;
+    std::atomic<bool> pinned_;
+    alignas(kCacheLineSize) uint64_t next_sequence_; // Producer thread only
+    alignas(kCacheLineSize) uint32_t current_book_;  // Matching thread only
+    uint64_t current_sequence_;
+};
+
+} // namespace OrderBookSystem
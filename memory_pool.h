@@ -1,86 +1,99 @@
-#pragma once
-
-#include <cstdint>
-#include <vector>
-#include <new> // for new(ptr)
-#include <utility> // for std::forward
-
-// Memory pool for fixed-size object allocations to minimize heap fragmentation and improve cache performance.
-template<typename T, size_t BlockSize = 4096>
-class MemoryPool {
-private:
-    struct Block {
-        // Ensure proper alignment for T to avoid undefined behavior
-        typename std::aligned_storage<sizeof(T), alignof(T)>::type data[BlockSize];
-        Block* next;
-    };
-    
-    Block* current_block_;
-    size_t current_offset_;
-    std::vector<Block*> all_blocks_;
-    std::vector<T*> free_list_; // Stores pointers to destroyed objects for reuse.
-    
-public:
-    MemoryPool() : current_block_(nullptr), current_offset_(0) {
-        allocate_new_block();
-    }
-    
-    ~MemoryPool() {
-        for (auto* block : all_blocks_) {
-            delete block;
-        }
-    }
-    
-    // Non-copyable to prevent accidental copying of the pool.
-    MemoryPool(const MemoryPool&) = delete;
-    MemoryPool& operator=(const MemoryPool&) = delete;
-    
-    // Allocate memory and construct an object in place.
-    template<typename... Args>
-    T* construct(Args&&... args) {
-        T* ptr = allocate();
-        new (ptr) T(std::forward<Args>(args)...); // Placement new
-        return ptr;
-    }
-    
-    // Destruct an object and return its memory to the free list.
-    void destroy(T* ptr) {
-        if (ptr) {
-            ptr->~T(); // Explicitly call the destructor
-            free_list_.push_back(ptr);
-        }
-    }
-    
-private:
-    void allocate_new_block() {
-        Block* new_block = new Block();
-        new_block->next = nullptr;
-        
-        // Link the new block to the list of all blocks for eventual cleanup
-        if (current_block_ != nullptr) {
-            current_block_->next = new_block;
-        }
-        all_blocks_.push_back(new_block);
-        current_block_ = new_block;
-        current_offset_ = 0;
-    }
-    
-    T* allocate() {
-        // First, try to reuse a previously destroyed object.
-        if (!free_list_.empty()) {
-            T* ptr = free_list_.back();
-            free_list_.pop_back();
-            return ptr;
-        }
-        
-        // If the current block is full, allocate a new one.
-        if (current_offset_ >= BlockSize) {
-            allocate_new_block();
-        }
-        
-        // Get the pointer to the next available slot in the current block's data array.
-        T* ptr = reinterpret_cast<T*>(&current_block_->data[current_offset_]);
-        ++current_offset_;
-        return ptr;
-    }
-};
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <new> // for std::bad_alloc
+#include <cstring>
+#include <sys/mman.h>
+
+// Memory mapping shared by the book's pools (OrderNodePool, PriceLevelPool)
+
+// How a pool obtains its memory
+struct MemoryPoolConfig {
+    size_t reserve_objects = 0; // Slots mapped up front; growth beyond them adds BlockSize slots at a time
+    bool huge_pages = false;    // Back chunks with 2MB pages: MAP_HUGETLB if the system has them reserved,
+                                // otherwise transparent huge pages via madvise
+    bool prefault = false;      // Touch every page as a chunk is mapped, so no first-touch fault hits the hot path
+};
+
+struct MemoryPoolStats {
+    size_t live;       // Objects constructed and not yet destroyed
+    size_t peak;       // Highest live count so far
+    size_t capacity;   // Object slots mapped
+    size_t chunks;     // Mappings made: the up-front reservation plus each later growth
+    size_t bytes;      // Bytes mapped
+    bool huge_pages;   // Every chunk is backed by explicit (MAP_HUGETLB) huge pages
+};
+
+namespace memory_pool_detail {
+constexpr size_t kHugePageSize = size_t(2) << 20;
+constexpr size_t kPageSize = 4096;
+}
+
+// Touch every page of [base + from, base + to)
+inline void prefault_pool_memory(void *base, size_t from, size_t to) {
+    volatile char *page = static_cast<char*>(base);
+    for (size_t offset = from; offset < to; offset += memory_pool_detail::kPageSize) {
+        page[offset] = 0;
+    }
+}
+
+// Map at least bytes of anonymous memory the way config asks for, rounding bytes up to whole
+// huge pages when they are requested. explicit_huge tells whether MAP_HUGETLB was used.
+inline void* map_pool_memory(size_t &bytes, const MemoryPoolConfig &config, bool &explicit_huge) {
+    explicit_huge = false;
+    void *base = MAP_FAILED;
+    if (config.huge_pages) {
+        bytes = (bytes + memory_pool_detail::kHugePageSize - 1) & ~(memory_pool_detail::kHugePageSize - 1);
+#ifdef MAP_HUGETLB
+        base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        explicit_huge = base != MAP_FAILED;
+#endif
+    }
+    if (base == MAP_FAILED) {
+        base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if (config.huge_pages) {
+            ::madvise(base, bytes, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    if (config.prefault) {
+        prefault_pool_memory(base, 0, bytes);
+    }
+    return base;
+}
+
+// Grow a mapping from map_pool_memory to at least new_bytes, keeping its contents. The mapping
+// may move. Falls back to map, copy and unmap where mremap cannot resize it (older kernels
+// refuse for MAP_HUGETLB).
+inline void* remap_pool_memory(void *base, size_t old_bytes, size_t &new_bytes, const MemoryPoolConfig &config,
+                               bool &explicit_huge) {
+    if (config.huge_pages) {
+        new_bytes = (new_bytes + memory_pool_detail::kHugePageSize - 1) & ~(memory_pool_detail::kHugePageSize - 1);
+    }
+    void *moved = MAP_FAILED;
+#ifdef MREMAP_MAYMOVE
+    moved = ::mremap(base, old_bytes, new_bytes, MREMAP_MAYMOVE);
+#endif
+    if (moved == MAP_FAILED) {
+        bool copy_huge = false;
+        moved = map_pool_memory(new_bytes, config, copy_huge);
+        std::memcpy(moved, base, old_bytes);
+        ::munmap(base, old_bytes);
+        explicit_huge = copy_huge;
+        return moved;
+    }
+#ifdef MADV_HUGEPAGE
+    if (config.huge_pages && !explicit_huge) {
+        ::madvise(moved, new_bytes, MADV_HUGEPAGE);
+    }
+#endif
+    if (config.prefault) {
+        prefault_pool_memory(moved, old_bytes, new_bytes);
+    }
+    return moved;
+}
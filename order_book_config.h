@@ -0,0 +1,105 @@
+#pragma once
+
+#include "common.h"
+#include "order_index.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace OrderBookSystem {
+
+// Storage used for the price levels on each side of the book
+enum class LevelStorage {
+    Map,    // std::map keyed by price; suits wide, sparse books
+    Ladder  // Dense array indexed by tick offset; suits books clustered around the touch. The
+            // window is capped at max_ladder_window ticks; levels beyond it sit in a sorted side
+            // map, so a stray far-away price costs a map node rather than a wider window
+};
+
+// Time priority of a resting order amended at its own price. A price change always moves the
+// order to the back of its new level.
+enum class AmendPriority : uint8_t {
+    SizeUpLoses, // Size-down keeps its place in the queue, size-up goes to the back (most venues)
+    Keep         // Any quantity change keeps its place
+};
+
+// Configuration for the order book system
+struct OrderBookConfig {
+    bool verbose_logging = true;
+    size_t default_snapshot_depth = 10;
+    double price_precision = 0.01; // Tick size; fixed for the lifetime of a book
+    LevelStorage level_storage = LevelStorage::Map; // Fixed for the lifetime of a book
+    size_t ladder_capacity = 4096; // Initial ladder window in ticks per side
+    size_t max_ladder_window = size_t(1) << 20; // Largest ladder window in ticks per side (about 4MB)
+    size_t expected_orders = 65536; // Resting orders the order ID index and node pool are sized for up front
+    OrderIndexPolicy order_index = OrderIndexPolicy::Hash; // Fixed for the lifetime of a book
+    size_t slab_window_orders = size_t(1) << 22; // ID range the slab index covers before overflowing
+    bool pool_huge_pages = false; // Back the order node pool with 2MB pages
+    bool pool_prefault = false;   // Touch the node pool's pages at construction instead of on first use
+    bool depth_index = false;     // Keep cumulative depth per side for O(log n) depth and FOK checks; fixed for the lifetime of a book
+    size_t max_depth_window = size_t(1) << 18; // Largest depth index window in ticks per side (about 6MB); levels beyond it are summed from a side map
+    AmendPriority amend_priority = AmendPriority::SizeUpLoses;
+
+    OrderBookConfig() = default;
+    OrderBookConfig(bool verbose, size_t depth, double precision)
+        : verbose_logging(verbose), default_snapshot_depth(depth), price_precision(precision) {}
+};
+
+// Summary of a checkpoint file, read without loading it
+struct CheckpointInfo {
+    OrderBookConfig config;
+    uint64_t journal_records; // Replay the journal from this record on
+    uint64_t order_count;
+};
+
+// How long the unfilled part of an order lives
+enum class TimeInForce : uint8_t {
+    Day, // Rests on the book
+    IOC, // Immediate or cancel: fills what it can, the rest is cancelled
+    FOK  // Fill or kill: fills completely on entry or not at all
+};
+
+// What an aggressive order would take from the opposite side, from estimate_fill
+struct FillEstimate {
+    uint64_t quantity; // Fillable within the limit, at most the quantity asked about
+    double worst_price; // Price of the last level reached (0 if nothing is fillable)
+    double notional;    // Sum of price x quantity over the fills
+};
+
+// The resting orders mass_cancel removes: those of owner_id (every owner if 0) on the chosen
+// sides with prices in [min_price, max_price]; bounds between ticks select only the ticks
+// inside them. The default selects the whole book.
+struct MassCancelRequest {
+    uint32_t owner_id = 0;
+    bool bids = true;
+    bool asks = true;
+    double min_price = -std::numeric_limits<double>::infinity();
+    double max_price = std::numeric_limits<double>::infinity();
+};
+
+// Outcome of a call auction, from indicative_uncross or uncross
+struct AuctionResult {
+    bool crossed;       // false if no bid meets an ask: nothing trades and price is 0
+    double price;       // Equilibrium price; every fill of the uncross is at this price
+    uint64_t volume;    // Quantity traded on each side
+    int64_t imbalance;  // Bids less asks executable at price: > 0 buyers left over, < 0 sellers
+};
+
+enum class CommandType : uint8_t { Add, Cancel, Amend };
+
+// One command for apply_batch. Cancels use order.order_id only; amends carry the new price
+// and quantity.
+struct BookCommand {
+    CommandType type;
+    Order order;
+};
+
+// Outcome of one batched command
+struct BookCommandResult {
+    uint64_t order_id;
+    bool accepted;            // false if a cancel or amend did not find its order
+    uint64_t filled_quantity; // Traded on entry (adds, and amends that moved price)
+    uint64_t resting_quantity; // Left on the book afterwards
+};
+
+} // namespace OrderBookSystem
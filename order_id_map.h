@@ -0,0 +1,165 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "price_level.h"
+
+namespace OrderBookSystem {
+
+// Open-addressing hash table from order ID to resting order node index.
+// Slots live in one flat array with linear probing, so a lookup is a multiply, a shift and
+// usually a single cache line. Deletion shifts later entries of the probe run back instead of
+// leaving tombstones, so probe lengths stay short under heavy cancel traffic. Capacity is
+// reserved up front and only grows (by doubling) past the maximum load factor.
+class OrderIdMap {
+public:
+    explicit OrderIdMap(size_t expected_size = 0) : size_(0) {
+        rehash(capacity_for(expected_size));
+    }
+
+    // Non-copyable: the book owns exactly one index.
+    OrderIdMap(const OrderIdMap&) = delete;
+    OrderIdMap& operator=(const OrderIdMap&) = delete;
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return slots_.size(); }
+    size_t memory_bytes() const { return slots_.size() * sizeof(Slot); }
+
+    // Make room for expected_size entries without further growth.
+    void reserve(size_t expected_size) {
+        size_t capacity = capacity_for(expected_size);
+        if (capacity > slots_.size()) {
+            rehash(capacity);
+        }
+    }
+
+    // Hint that order_id is about to be looked up or inserted, to overlap bulk-load cache misses.
+    void prefetch(uint64_t order_id) const {
+        __builtin_prefetch(&slots_[home(order_id)]);
+    }
+
+    NodeIndex find(uint64_t order_id) const {
+        for (size_t i = home(order_id);; i = (i + 1) & mask_) {
+            const Slot &slot = slots_[i];
+            if (slot.node == kNoNode) {
+                return kNoNode;
+            }
+            if (slot.order_id == order_id) {
+                return slot.node;
+            }
+        }
+    }
+
+    // Insert or overwrite the node stored for order_id.
+    void insert(uint64_t order_id, NodeIndex node) {
+        if ((size_ + 1) * kMaxLoadDen > slots_.size() * kMaxLoadNum) {
+            rehash(slots_.size() * 2);
+        }
+        for (size_t i = home(order_id);; i = (i + 1) & mask_) {
+            Slot &slot = slots_[i];
+            if (slot.node == kNoNode) {
+                slot.order_id = order_id;
+                slot.node = node;
+                ++size_;
+                return;
+            }
+            if (slot.order_id == order_id) {
+                slot.node = node;
+                return;
+            }
+        }
+    }
+
+    bool erase(uint64_t order_id) {
+        size_t i = home(order_id);
+        while (true) {
+            if (slots_[i].node == kNoNode) {
+                return false;
+            }
+            if (slots_[i].order_id == order_id) {
+                break;
+            }
+            i = (i + 1) & mask_;
+        }
+
+        // Backward-shift: pull later entries of the run into the hole when their home slot
+        // does not lie cyclically in (hole, j].
+        size_t hole = i;
+        for (size_t j = (hole + 1) & mask_; slots_[j].node != kNoNode; j = (j + 1) & mask_) {
+            size_t k = home(slots_[j].order_id);
+            bool stays = (hole <= j) ? (hole < k && k <= j) : (hole < k || k <= j);
+            if (!stays) {
+                slots_[hole] = slots_[j];
+                hole = j;
+            }
+        }
+        slots_[hole].node = kNoNode;
+        --size_;
+        return true;
+    }
+
+    void clear() {
+        for (Slot &slot : slots_) {
+            slot.node = kNoNode;
+        }
+        size_ = 0;
+    }
+
+    // Visit every (order_id, node) entry in unspecified order.
+    template<typename Fn>
+    void for_each(Fn &&fn) const {
+        for (const Slot &slot : slots_) {
+            if (slot.node != kNoNode) {
+                fn(slot.order_id, slot.node);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        uint64_t order_id;
+        NodeIndex node; // kNoNode marks an empty slot
+    };
+
+    static constexpr size_t kMinCapacity = 16;
+    static constexpr size_t kMaxLoadNum = 7; // Grow above 70% load
+    static constexpr size_t kMaxLoadDen = 10;
+
+    static size_t capacity_for(size_t expected_size) {
+        size_t capacity = kMinCapacity;
+        while (capacity * kMaxLoadNum < expected_size * kMaxLoadDen) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    // Fibonacci hashing spreads sequential IDs across the table.
+    size_t home(uint64_t order_id) const {
+        return static_cast<size_t>((order_id * 0x9E3779B97F4A7C15ULL) >> shift_);
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old_slots(capacity, Slot{0, kNoNode});
+        old_slots.swap(slots_);
+        mask_ = capacity - 1;
+        shift_ = 64;
+        for (size_t c = capacity; c > 1; c >>= 1) {
+            --shift_;
+        }
+
+        size_ = 0;
+        for (const Slot &slot : old_slots) {
+            if (slot.node != kNoNode) {
+                insert(slot.order_id, slot.node);
+            }
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t size_;
+    size_t mask_;
+    unsigned shift_;
+};
+
+} // namespace OrderBookSystem
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "order_id_map.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OrderBookSystem {
+
+// Direct-indexed order ID index for venues that assign IDs monotonically.
+// IDs are split into segments of kSegmentSize slots; a ring of segment pointers covers a sliding
+// window of recent IDs, so a lookup is a shift, a mask and two loads with no hashing or probing.
+// Segments whose orders have all gone are reclaimed from the back of the window and recycled.
+// IDs that fall outside the window (old stragglers pushed out, or far jumps) go to an overflow
+// hash index, so arbitrary IDs still work, only more slowly.
+class OrderIdSlab {
+public:
+    static constexpr unsigned kSegmentBits = 12;
+    static constexpr size_t kSegmentSize = size_t(1) << kSegmentBits;
+
+    explicit OrderIdSlab(size_t max_window_ids = size_t(1) << 22)
+        : max_segments_(round_up_pow2((max_window_ids + kSegmentSize - 1) / kSegmentSize)),
+          ring_(1, nullptr), ring_mask_(0), first_segment_(0), last_segment_(0),
+          window_size_(0), overflow_(0) {}
+
+    ~OrderIdSlab() {
+        for (Segment *segment : ring_) {
+            delete segment;
+        }
+        for (Segment *segment : spare_segments_) {
+            delete segment;
+        }
+    }
+
+    // Non-copyable: owns its segments.
+    OrderIdSlab(const OrderIdSlab&) = delete;
+    OrderIdSlab& operator=(const OrderIdSlab&) = delete;
+
+    size_t size() const { return window_size_ + overflow_.size(); }
+
+    size_t memory_bytes() const {
+        size_t segments = spare_segments_.size();
+        for (const Segment *segment : ring_) {
+            segments += (segment != nullptr);
+        }
+        return ring_.size() * sizeof(Segment*) + segments * sizeof(Segment) + overflow_.memory_bytes();
+    }
+
+    NodeIndex find(uint64_t order_id) const {
+        uint64_t segment_no = order_id >> kSegmentBits;
+        if (segment_no - first_segment_ < ring_.size()) {
+            const Segment *segment = ring_[segment_no & ring_mask_];
+            if (segment != nullptr) {
+                return segment->nodes[order_id & (kSegmentSize - 1)];
+            }
+            return kNoNode;
+        }
+        return overflow_.size() > 0 ? overflow_.find(order_id) : kNoNode;
+    }
+
+    // Hint that order_id is about to be looked up. Overflow IDs are not prefetched.
+    void prefetch(uint64_t order_id) const {
+        uint64_t segment_no = order_id >> kSegmentBits;
+        if (segment_no - first_segment_ < ring_.size()) {
+            const Segment *segment = ring_[segment_no & ring_mask_];
+            if (segment != nullptr) {
+                __builtin_prefetch(&segment->nodes[order_id & (kSegmentSize - 1)]);
+            }
+        }
+    }
+
+    // Insert or overwrite the node stored for order_id.
+    void insert(uint64_t order_id, NodeIndex node) {
+        uint64_t segment_no = order_id >> kSegmentBits;
+        if (window_size_ == 0 && segment_no - first_segment_ >= ring_.size()) {
+            // Empty window: jump it to the new ID
+            release_window();
+            first_segment_ = segment_no;
+            last_segment_ = segment_no;
+        }
+        if (segment_no < first_segment_) {
+            overflow_.insert(order_id, node); // Older than the window
+            return;
+        }
+        if (segment_no - first_segment_ >= ring_.size()) {
+            make_room(segment_no);
+            if (segment_no - first_segment_ >= ring_.size()) {
+                overflow_.insert(order_id, node);
+                return;
+            }
+        }
+
+        Segment *&segment = ring_[segment_no & ring_mask_];
+        if (segment == nullptr) {
+            segment = acquire_segment();
+        }
+        NodeIndex &slot = segment->nodes[order_id & (kSegmentSize - 1)];
+        if (slot == kNoNode) {
+            ++segment->live;
+            ++window_size_;
+        }
+        slot = node;
+        if (segment_no > last_segment_) {
+            last_segment_ = segment_no;
+        }
+    }
+
+    bool erase(uint64_t order_id) {
+        uint64_t segment_no = order_id >> kSegmentBits;
+        if (segment_no - first_segment_ >= ring_.size()) {
+            return overflow_.size() > 0 && overflow_.erase(order_id);
+        }
+
+        Segment *segment = ring_[segment_no & ring_mask_];
+        if (segment == nullptr) {
+            return false;
+        }
+        NodeIndex &slot = segment->nodes[order_id & (kSegmentSize - 1)];
+        if (slot == kNoNode) {
+            return false;
+        }
+        slot = kNoNode;
+        --segment->live;
+        --window_size_;
+        if (segment->live == 0 && segment_no == first_segment_) {
+            reclaim_front();
+        }
+        return true;
+    }
+
+    void clear() {
+        release_window();
+        overflow_.clear();
+    }
+
+    // Visit every (order_id, node) entry in unspecified order.
+    template<typename Fn>
+    void for_each(Fn &&fn) const {
+        for (size_t i = 0; i < ring_.size(); ++i) {
+            uint64_t segment_no = first_segment_ + i;
+            const Segment *segment = ring_[segment_no & ring_mask_];
+            if (segment == nullptr || segment->live == 0) {
+                continue;
+            }
+            for (size_t slot = 0; slot < kSegmentSize; ++slot) {
+                if (segment->nodes[slot] != kNoNode) {
+                    fn((segment_no << kSegmentBits) | slot, segment->nodes[slot]);
+                }
+            }
+        }
+        overflow_.for_each(fn);
+    }
+
+private:
+    struct Segment {
+        NodeIndex nodes[kSegmentSize];
+        uint32_t live;
+    };
+
+    static size_t round_up_pow2(size_t n) {
+        size_t result = 1;
+        while (result < n) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    Segment* acquire_segment() {
+        if (!spare_segments_.empty()) {
+            Segment *segment = spare_segments_.back();
+            spare_segments_.pop_back();
+            return segment;
+        }
+        Segment *segment = new Segment;
+        for (NodeIndex &node : segment->nodes) {
+            node = kNoNode;
+        }
+        segment->live = 0;
+        return segment;
+    }
+
+    // Segments are only recycled once empty, so they come back zeroed.
+    void release_segment(Segment *&segment) {
+        if (segment != nullptr) {
+            spare_segments_.push_back(segment);
+            segment = nullptr;
+        }
+    }
+
+    void release_window() {
+        for (Segment *&segment : ring_) {
+            if (segment != nullptr && segment->live != 0) {
+                for (NodeIndex &node : segment->nodes) {
+                    node = kNoNode;
+                }
+                segment->live = 0;
+            }
+            release_segment(segment);
+        }
+        window_size_ = 0;
+    }
+
+    // Advance the window past empty segments, but keep the newest one for incoming IDs.
+    void reclaim_front() {
+        while (first_segment_ < last_segment_) {
+            Segment *&segment = ring_[first_segment_ & ring_mask_];
+            if (segment != nullptr && segment->live != 0) {
+                break;
+            }
+            release_segment(segment);
+            ++first_segment_;
+        }
+    }
+
+    // Extend the window to cover segment_no: reclaim empty segments, grow the ring up to
+    // max_segments_, and finally move the oldest live segments into the overflow index.
+    void make_room(uint64_t segment_no) {
+        reclaim_front();
+        while (segment_no - first_segment_ >= ring_.size()) {
+            if (window_size_ == 0) {
+                release_window();
+                first_segment_ = segment_no;
+                last_segment_ = segment_no;
+                return;
+            }
+            if (ring_.size() < max_segments_) {
+                grow_ring();
+                continue;
+            }
+
+            Segment *&segment = ring_[first_segment_ & ring_mask_];
+            if (segment != nullptr) {
+                for (size_t slot = 0; slot < kSegmentSize; ++slot) {
+                    NodeIndex &node = segment->nodes[slot];
+                    if (node != kNoNode) {
+                        overflow_.insert((first_segment_ << kSegmentBits) | slot, node);
+                        node = kNoNode;
+                    }
+                }
+                window_size_ -= segment->live;
+                segment->live = 0;
+                release_segment(segment);
+            }
+            ++first_segment_;
+        }
+    }
+
+    void grow_ring() {
+        std::vector<Segment*> new_ring(ring_.size() * 2, nullptr);
+        size_t new_mask = new_ring.size() - 1;
+        for (size_t i = 0; i < ring_.size(); ++i) {
+            uint64_t segment_no = first_segment_ + i;
+            new_ring[segment_no & new_mask] = ring_[segment_no & ring_mask_];
+        }
+        ring_.swap(new_ring);
+        ring_mask_ = new_mask;
+    }
+
+    size_t max_segments_;
+    std::vector<Segment*> ring_;        // ring_[segment_no & ring_mask_] for segments in the window
+    size_t ring_mask_;
+    uint64_t first_segment_;            // Oldest segment in the window
+    uint64_t last_segment_;             // Newest segment that has received an ID
+    size_t window_size_;                // Live entries inside the window
+    std::vector<Segment*> spare_segments_;
+    OrderIdMap overflow_;
+};
+
+} // namespace OrderBookSystem
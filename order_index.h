@@ -0,0 +1,83 @@
+#pragma once
+
+#include "order_id_map.h"
+#include "order_id_slab.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace OrderBookSystem {
+
+// How the book maps order IDs to resting orders
+enum class OrderIndexPolicy {
+    Hash, // Open-addressing hash table; any ID scheme
+    Slab  // Direct-indexed window over recent IDs; for dense, monotonically assigned IDs
+};
+
+// Order ID index used by OrderBook, dispatching to the configured policy.
+class OrderIndex {
+public:
+    OrderIndex(OrderIndexPolicy policy, size_t expected_orders, size_t slab_window_ids)
+        : use_slab_(policy == OrderIndexPolicy::Slab),
+          hash_(use_slab_ ? 0 : expected_orders),
+          slab_(slab_window_ids) {}
+
+    OrderIndexPolicy policy() const { return use_slab_ ? OrderIndexPolicy::Slab : OrderIndexPolicy::Hash; }
+
+    NodeIndex find(uint64_t order_id) const {
+        return use_slab_ ? slab_.find(order_id) : hash_.find(order_id);
+    }
+
+    void insert(uint64_t order_id, NodeIndex node) {
+        if (use_slab_) {
+            slab_.insert(order_id, node);
+        } else {
+            hash_.insert(order_id, node);
+        }
+    }
+
+    bool erase(uint64_t order_id) {
+        return use_slab_ ? slab_.erase(order_id) : hash_.erase(order_id);
+    }
+
+    size_t size() const { return use_slab_ ? slab_.size() : hash_.size(); }
+
+    void prefetch(uint64_t order_id) const {
+        if (use_slab_) {
+            slab_.prefetch(order_id);
+        } else {
+            hash_.prefetch(order_id);
+        }
+    }
+
+    // Make room for expected_orders without growth; the slab allocates segments as needed.
+    void reserve(size_t expected_orders) {
+        if (!use_slab_) {
+            hash_.reserve(expected_orders);
+        }
+    }
+    size_t memory_bytes() const { return use_slab_ ? slab_.memory_bytes() : hash_.memory_bytes(); }
+
+    void clear() {
+        if (use_slab_) {
+            slab_.clear();
+        } else {
+            hash_.clear();
+        }
+    }
+
+    template<typename Fn>
+    void for_each(Fn &&fn) const {
+        if (use_slab_) {
+            slab_.for_each(fn);
+        } else {
+            hash_.for_each(fn);
+        }
+    }
+
+private:
+    bool use_slab_;
+    OrderIdMap hash_;
+    OrderIdSlab slab_;
+};
+
+} // namespace OrderBookSystem
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "price_level.h"
+#include "memory_pool.h"
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <sys/mman.h>
+
+namespace OrderBookSystem {
+
+// Resting order nodes as two parallel arrays addressed by NodeIndex: hot fields (id, quantity,
+// links) in one, cold fields (level, timestamp, entry quantity, side) in the other. A queue walk
+// touches 24 bytes per order instead of a whole heap node, and links are half the size of
+// pointers. Freed nodes form an intrusive free list threaded through hot.next; new ones are
+// bumped off the end. Both arrays are single mmap'd regions that grow in place (mremap), so
+// indices stay valid across growth but references into the arrays do not: never hold a
+// hot()/cold() reference across allocate().
+class OrderNodePool {
+private:
+    static constexpr size_t kGrowthNodes = 4096;
+    static constexpr size_t kMaxNodes = size_t(UINT32_MAX); // Largest NodeIndex plus the reserved 0
+
+    MemoryPoolConfig config_;
+    OrderNodeHot *hot_;
+    OrderNodeCold *cold_;
+    size_t hot_bytes_;
+    size_t cold_bytes_;
+    size_t slots_;      // Usable length of both arrays, including the reserved slot 0
+    NodeIndex free_list_;
+    size_t bump_;       // Next never-used slot
+    size_t live_;
+    size_t peak_;
+    size_t mappings_;
+    bool hot_huge_;
+    bool cold_huge_;
+
+public:
+    explicit OrderNodePool(const MemoryPoolConfig &config = MemoryPoolConfig())
+        : config_(config), hot_(nullptr), cold_(nullptr), hot_bytes_(0), cold_bytes_(0), slots_(0),
+          free_list_(kNoNode), bump_(1), live_(0), peak_(0), mappings_(0), hot_huge_(false), cold_huge_(false) {
+        size_t nodes = (config.reserve_objects > 0 ? config.reserve_objects : kGrowthNodes) + 1;
+        hot_bytes_ = nodes * sizeof(OrderNodeHot);
+        cold_bytes_ = nodes * sizeof(OrderNodeCold);
+        hot_ = static_cast<OrderNodeHot*>(map_pool_memory(hot_bytes_, config_, hot_huge_));
+        cold_ = static_cast<OrderNodeCold*>(map_pool_memory(cold_bytes_, config_, cold_huge_));
+        mappings_ = 1;
+        update_slots();
+    }
+
+    ~OrderNodePool() {
+        ::munmap(hot_, hot_bytes_);
+        ::munmap(cold_, cold_bytes_);
+    }
+
+    OrderNodePool(const OrderNodePool&) = delete;
+    OrderNodePool& operator=(const OrderNodePool&) = delete;
+
+    // A node with unspecified contents; may grow (and move) the arrays.
+    NodeIndex allocate() {
+        NodeIndex node;
+        if (free_list_ != kNoNode) {
+            node = free_list_;
+            free_list_ = hot_[node].next;
+        } else {
+            if (bump_ == slots_) {
+                // Doubling keeps the number of remaps logarithmic; untouched pages cost no memory
+                grow(slots_ + (slots_ > kGrowthNodes ? slots_ : kGrowthNodes));
+            }
+            node = static_cast<NodeIndex>(bump_++);
+        }
+        if (++live_ > peak_) {
+            peak_ = live_;
+        }
+        return node;
+    }
+
+    void release(NodeIndex node) {
+        hot_[node].next = free_list_;
+        free_list_ = node;
+        --live_;
+    }
+
+    // Release count nodes linked head to tail through hot.next, as one splice onto the free list
+    void release_list(NodeIndex head, NodeIndex tail, size_t count) {
+        hot_[tail].next = free_list_;
+        free_list_ = head;
+        live_ -= count;
+    }
+
+    OrderNodeHot& hot(NodeIndex node) { return hot_[node]; }
+    const OrderNodeHot& hot(NodeIndex node) const { return hot_[node]; }
+    OrderNodeCold& cold(NodeIndex node) { return cold_[node]; }
+    const OrderNodeCold& cold(NodeIndex node) const { return cold_[node]; }
+
+    // Start loading a node's hot fields; kNoNode prefetches the unused slot 0, which is harmless.
+    void prefetch(NodeIndex node) const {
+        __builtin_prefetch(&hot_[node]);
+    }
+
+    // Make sure at least nodes nodes fit without growing.
+    void reserve(size_t nodes) {
+        if (nodes + 1 > slots_) {
+            grow(nodes + 1);
+        }
+    }
+
+    MemoryPoolStats stats() const {
+        return {live_, peak_, slots_ - 1, mappings_, hot_bytes_ + cold_bytes_, hot_huge_ && cold_huge_};
+    }
+
+private:
+    void update_slots() {
+        size_t hot_slots = hot_bytes_ / sizeof(OrderNodeHot);
+        size_t cold_slots = cold_bytes_ / sizeof(OrderNodeCold);
+        slots_ = hot_slots < cold_slots ? hot_slots : cold_slots;
+        if (slots_ > kMaxNodes) {
+            slots_ = kMaxNodes;
+        }
+    }
+
+    void grow(size_t nodes) {
+        if (nodes > kMaxNodes) {
+            if (slots_ >= kMaxNodes) {
+                throw std::bad_alloc();
+            }
+            nodes = kMaxNodes;
+        }
+        size_t hot_bytes = nodes * sizeof(OrderNodeHot);
+        size_t cold_bytes = nodes * sizeof(OrderNodeCold);
+        if (hot_bytes > hot_bytes_) {
+            hot_ = static_cast<OrderNodeHot*>(remap_pool_memory(hot_, hot_bytes_, hot_bytes, config_, hot_huge_));
+            hot_bytes_ = hot_bytes;
+        }
+        if (cold_bytes > cold_bytes_) {
+            cold_ = static_cast<OrderNodeCold*>(remap_pool_memory(cold_, cold_bytes_, cold_bytes, config_, cold_huge_));
+            cold_bytes_ = cold_bytes;
+        }
+        ++mappings_;
+        update_slots();
+    }
+};
+
+} // namespace OrderBookSystem
@@ -0,0 +1,259 @@
+#pragma once
+
+#include "price_level.h"
+#include "price_level_pool.h"
+#include "level_bitmap.h"
+#include <cstddef>
+#include <iterator> // for std::prev
+#include <map>
+#include <vector>
+#include <utility> // for std::move
+
+namespace OrderBookSystem {
+
+// Dense, array-indexed price levels for one side of the book.
+// Slot i holds the pool index of the level for price base_ + i (kNoLevel when empty), so
+// finding a level is a subtraction and an index instead of a tree walk. The levels themselves
+// live in a PriceLevelPool, so re-centring only moves indices and never a level. The window re-centres (growing if needed) when a price falls
+// outside it, which is rare for books clustered within a few thousand ticks of the touch.
+// The window never grows past max_window slots: a level that cannot fit alongside the others
+// (a fat-finger price far from the touch) is kept in a small sorted side map instead, and
+// moves into the window when a later re-centre covers it.
+// An occupancy bitmap finds the next non-empty level without scanning empty slots.
+class PriceLadder {
+public:
+    // Levels are allocated from and released to pool, which may be shared with other ladders.
+    PriceLadder(bool is_bid, size_t capacity, size_t max_window, PriceLevelPool *pool)
+        : is_bid_(is_bid), pool_(pool), base_(0), best_(0), level_count_(0),
+          max_window_(max_window > capacity ? max_window : capacity),
+          levels_(capacity > 0 ? capacity : 1, kNoLevel) {
+        occupied_.reset(levels_.size());
+    }
+
+    // Non-copyable: holds the indices of the levels it allocated from the pool.
+    PriceLadder(const PriceLadder&) = delete;
+    PriceLadder& operator=(const PriceLadder&) = delete;
+
+    bool empty() const { return level_count_ == 0; }
+    size_t level_count() const { return level_count_; }
+
+    // Levels held outside the window
+    size_t far_level_count() const { return far_.size(); }
+
+    PriceLevelQueue* best() {
+        return level_count_ > 0 ? &pool_->at(level_at(best_)) : nullptr;
+    }
+
+    const PriceLevelQueue* best() const {
+        return level_count_ > 0 ? &pool_->at(level_at(best_)) : nullptr;
+    }
+
+    PriceLevelQueue* find(PriceTicks price) const {
+        if (!in_window(price)) {
+            auto it = far_.find(price);
+            return it == far_.end() ? nullptr : &pool_->at(it->second);
+        }
+        if (levels_[price - base_] == kNoLevel) {
+            return nullptr;
+        }
+        return &pool_->at(levels_[price - base_]);
+    }
+
+    // Hint that the level at price is about to be used; prices outside the window and empty
+    // slots are ignored.
+    void prefetch(PriceTicks price) const {
+        if (in_window(price) && levels_[price - base_] != kNoLevel) {
+            __builtin_prefetch(&pool_->at(levels_[price - base_]));
+        }
+    }
+
+    // The level at price, allocating it if the slot is empty. index receives its pool index.
+    PriceLevelQueue* find_or_create(PriceTicks price, LevelIndex &index) {
+        if (!in_window(price) && !recenter(price)) {
+            auto it = far_.lower_bound(price);
+            if (it == far_.end() || it->first != price) {
+                it = far_.emplace_hint(it, price, pool_->allocate(price));
+                note_new_level(price);
+            }
+            index = it->second;
+            return &pool_->at(index);
+        }
+
+        LevelIndex &slot = levels_[price - base_];
+        if (slot == kNoLevel) {
+            // New level: the caller is about to link an order into it
+            slot = pool_->allocate(price);
+            occupied_.set(price - base_);
+            note_new_level(price);
+        }
+        index = slot;
+        return &pool_->at(slot);
+    }
+
+    // Release the (empty) level at price. Only the best level needs a scan for its successor.
+    void remove(PriceTicks price) {
+        if (in_window(price)) {
+            LevelIndex &slot = levels_[price - base_];
+            pool_->release(slot);
+            slot = kNoLevel;
+            occupied_.clear(price - base_);
+        } else {
+            auto it = far_.find(price);
+            pool_->release(it->second);
+            far_.erase(it);
+        }
+
+        if (--level_count_ > 0 && price == best_) {
+            next_occupied(price, best_);
+        }
+    }
+
+    // Next non-empty level strictly worse than price (which need not be a level), or nullptr.
+    PriceLevelQueue* next_worse(PriceTicks price) const {
+        PriceTicks next;
+        if (level_count_ == 0 || !next_occupied(price, next)) {
+            return nullptr;
+        }
+        return &pool_->at(level_at(next));
+    }
+
+    // Visit up to depth non-empty levels from best to worst.
+    template<typename Fn>
+    void for_each(size_t depth, Fn &&fn) const {
+        if (level_count_ == 0) {
+            return;
+        }
+        size_t limit = depth < level_count_ ? depth : level_count_;
+        PriceTicks price = best_;
+        for (size_t visited = 0; visited < limit; ++visited) {
+            fn(static_cast<const PriceLevelQueue&>(pool_->at(level_at(price))));
+            if (visited + 1 < limit) {
+                next_occupied(price, price);
+            }
+        }
+    }
+
+private:
+    bool is_better(PriceTicks a, PriceTicks b) const { return is_bid_ ? a > b : a < b; }
+
+    bool in_window(PriceTicks price) const {
+        return price >= base_ && price < base_ + static_cast<PriceTicks>(levels_.size());
+    }
+
+    // Pool index of the non-empty level at price, in the window or the side map
+    LevelIndex level_at(PriceTicks price) const {
+        return in_window(price) ? levels_[price - base_] : far_.find(price)->second;
+    }
+
+    void note_new_level(PriceTicks price) {
+        if (level_count_ == 0 || is_better(price, best_)) {
+            best_ = price;
+        }
+        ++level_count_;
+    }
+
+    // Price of the next non-empty level strictly worse than price (which need not be a level),
+    // searching the window and the side map. Returns false if there is none.
+    bool next_occupied(PriceTicks price, PriceTicks &next) const {
+        PriceTicks last = base_ + static_cast<PriceTicks>(levels_.size()) - 1;
+        size_t slot = LevelBitmap::npos;
+        if (is_bid_) {
+            if (price > base_) {
+                slot = occupied_.prev_set(static_cast<size_t>((price - 1 < last ? price - 1 : last) - base_));
+            }
+        } else if (price < last) {
+            slot = occupied_.next_set(static_cast<size_t>((price + 1 > base_ ? price + 1 : base_) - base_));
+        }
+        bool found = slot != LevelBitmap::npos;
+        if (found) {
+            next = base_ + static_cast<PriceTicks>(slot);
+        }
+        if (far_.empty()) {
+            return found;
+        }
+
+        // The side map holds few levels; take its candidate if it beats the window's
+        if (is_bid_) {
+            auto it = far_.lower_bound(price);
+            if (it != far_.begin() && (!found || std::prev(it)->first > next)) {
+                next = std::prev(it)->first;
+                found = true;
+            }
+        } else {
+            auto it = far_.upper_bound(price);
+            if (it != far_.end() && (!found || it->first < next)) {
+                next = it->first;
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    // Move the window so that it covers price and every level it holds, centred on that range,
+    // and pull in side-map levels the new window covers. Returns false, leaving the window
+    // unchanged, if that would take more than max_window_ slots.
+    bool recenter(PriceTicks price) {
+        PriceTicks lo = price;
+        PriceTicks hi = price;
+        size_t lowest_slot = occupied_.next_set(0);
+        if (lowest_slot != LevelBitmap::npos) {
+            PriceTicks lowest = base_ + static_cast<PriceTicks>(lowest_slot);
+            PriceTicks highest = base_ + static_cast<PriceTicks>(occupied_.prev_set(levels_.size() - 1));
+            lo = lowest < lo ? lowest : lo;
+            hi = highest > hi ? highest : hi;
+        }
+
+        if (static_cast<uint64_t>(hi - lo) >= max_window_) {
+            return false;
+        }
+        size_t span = static_cast<size_t>(hi - lo) + 1;
+        size_t capacity = levels_.size();
+        while (capacity < span * 2 && capacity < max_window_) {
+            capacity *= 2;
+        }
+        capacity = capacity < max_window_ ? capacity : max_window_;
+        PriceTicks new_base = lo - static_cast<PriceTicks>((capacity - span) / 2);
+
+        if (lowest_slot == LevelBitmap::npos && capacity == levels_.size()) {
+            base_ = new_base; // Nothing to move
+            adopt_far_levels();
+            return true;
+        }
+
+        std::vector<LevelIndex> new_levels(capacity, kNoLevel);
+        LevelBitmap new_occupied(capacity);
+        for (size_t slot = occupied_.next_set(0); slot != LevelBitmap::npos;
+             slot = occupied_.next_set(slot + 1)) {
+            size_t new_slot = static_cast<size_t>(base_ + static_cast<PriceTicks>(slot) - new_base);
+            new_levels[new_slot] = levels_[slot];
+            new_occupied.set(new_slot);
+        }
+
+        levels_.swap(new_levels);
+        occupied_ = std::move(new_occupied);
+        base_ = new_base;
+        adopt_far_levels();
+        return true;
+    }
+
+    // Move side-map levels that now fall inside the window into it
+    void adopt_far_levels() {
+        PriceTicks end = base_ + static_cast<PriceTicks>(levels_.size());
+        for (auto it = far_.lower_bound(base_); it != far_.end() && it->first < end; it = far_.erase(it)) {
+            levels_[it->first - base_] = it->second;
+            occupied_.set(static_cast<size_t>(it->first - base_));
+        }
+    }
+
+    bool is_bid_;
+    PriceLevelPool *pool_;
+    PriceTicks base_;        // Price of levels_[0]
+    PriceTicks best_;        // Valid only while level_count_ > 0
+    size_t level_count_;     // Number of non-empty levels, in the window and the side map
+    size_t max_window_;      // Largest window in slots
+    std::vector<LevelIndex> levels_;
+    LevelBitmap occupied_;   // One bit per slot of levels_
+    std::map<PriceTicks, LevelIndex> far_; // Levels outside the window, by price
+};
+
+} // namespace OrderBookSystem
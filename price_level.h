@@ -0,0 +1,52 @@
+#pragma once
+
+#include "common.h"
+#include "price_ticks.h"
+#include <cstdint>
+
+namespace OrderBookSystem {
+
+// Resting orders live in OrderNodePool and are linked by 32-bit pool index; 0 is "no node".
+using NodeIndex = uint32_t;
+constexpr NodeIndex kNoNode = 0;
+
+// Price levels live in PriceLevelPool, addressed the same way; 0 is "no level".
+using LevelIndex = uint32_t;
+constexpr LevelIndex kNoLevel = 0;
+
+// Fields the matching loop touches for every resting order it fills: 24 bytes, so a queue
+// walk pulls in little besides quantities and links.
+struct OrderNodeHot {
+    uint64_t order_id;
+    uint64_t quantity; // Remaining quantity
+    NodeIndex next;
+    NodeIndex prev;
+};
+
+// Fields only needed on entry, cancel, amend, mass cancel and reporting
+struct OrderNodeCold {
+    uint64_t timestamp_ns;
+    uint64_t original_quantity; // Quantity when entered or last amended
+    LevelIndex level;           // The level whose queue holds this order; its price is the order's price
+    uint32_t owner_id;          // 0 if the order has no owner
+    NodeIndex owner_next;       // The owner's resting orders, newest first
+    NodeIndex owner_prev;
+    bool is_buy;
+};
+
+// Price level queue structure - manages orders at a specific price. Lives at a fixed address
+// in PriceLevelPool for as long as it has orders.
+struct PriceLevelQueue {
+    PriceTicks price;
+    uint64_t total_quantity;
+    NodeIndex head;
+    NodeIndex tail;
+
+    PriceLevelQueue(PriceTicks p) : price(p), total_quantity(0), head(kNoNode), tail(kNoNode) {}
+
+    // Disable copy constructor and assignment to prevent accidental copying
+    PriceLevelQueue(const PriceLevelQueue&) = delete;
+    PriceLevelQueue& operator=(const PriceLevelQueue&) = delete;
+};
+
+} // namespace OrderBookSystem
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "price_level.h"
+#include "memory_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <sys/mman.h>
+
+namespace OrderBookSystem {
+
+// Price levels with stable addresses, addressed by 32-bit LevelIndex (0 is "no level").
+// Levels live in fixed chunks that are never moved or unmapped while the pool lives, so
+// orders and the ordered level index can refer to a level across any amount of churn
+// elsewhere. An emptied level goes on a free list threaded through its head field and is the
+// first to be reused, so a level appearing and disappearing at the touch does not allocate.
+class PriceLevelPool {
+public:
+    static constexpr unsigned kChunkBits = 10;
+    static constexpr size_t kChunkLevels = size_t(1) << kChunkBits;
+
+    PriceLevelPool() : free_list_(kNoLevel), bump_(1), live_(0), peak_(0) {
+        add_chunk(); // Slot 0 of the first chunk stays unused
+    }
+
+    ~PriceLevelPool() {
+        for (PriceLevelQueue *chunk : chunks_) {
+            ::munmap(chunk, kChunkBytes);
+        }
+    }
+
+    // Non-copyable: orders refer to levels by index into this pool.
+    PriceLevelPool(const PriceLevelPool&) = delete;
+    PriceLevelPool& operator=(const PriceLevelPool&) = delete;
+
+    // An empty level at price.
+    LevelIndex allocate(PriceTicks price) {
+        LevelIndex level;
+        if (free_list_ != kNoLevel) {
+            level = free_list_;
+            free_list_ = at(level).head;
+        } else {
+            if (bump_ == chunks_.size() * kChunkLevels) {
+                add_chunk();
+            }
+            level = static_cast<LevelIndex>(bump_++);
+        }
+        if (++live_ > peak_) {
+            peak_ = live_;
+        }
+        new (&at(level)) PriceLevelQueue(price);
+        return level;
+    }
+
+    void release(LevelIndex level) {
+        at(level).head = free_list_;
+        free_list_ = level;
+        --live_;
+    }
+
+    PriceLevelQueue& at(LevelIndex level) {
+        return chunks_[level >> kChunkBits][level & (kChunkLevels - 1)];
+    }
+    const PriceLevelQueue& at(LevelIndex level) const {
+        return chunks_[level >> kChunkBits][level & (kChunkLevels - 1)];
+    }
+
+    MemoryPoolStats stats() const {
+        size_t capacity = chunks_.size() * kChunkLevels - 1;
+        return {live_, peak_, capacity, chunks_.size(), chunks_.size() * kChunkBytes, false};
+    }
+
+private:
+    static constexpr size_t kChunkBytes = kChunkLevels * sizeof(PriceLevelQueue);
+
+    void add_chunk() {
+        size_t bytes = kChunkBytes;
+        bool explicit_huge = false;
+        chunks_.push_back(static_cast<PriceLevelQueue*>(map_pool_memory(bytes, MemoryPoolConfig(), explicit_huge)));
+    }
+
+    std::vector<PriceLevelQueue*> chunks_;
+    LevelIndex free_list_;
+    size_t bump_;       // Next never-used index
+    size_t live_;
+    size_t peak_;
+};
+
+// Recycles the tree nodes of the std::map level indexes. Every node of one map type has the
+// same size, so freed nodes go on a free list and are handed out again before any new chunk
+// is carved; requests of another size fall through to operator new.
+class MapNodePool {
+public:
+    MapNodePool() : block_bytes_(0), free_list_(nullptr), bump_(nullptr), bump_end_(nullptr) {}
+
+    ~MapNodePool() {
+        for (void *chunk : chunks_) {
+            ::munmap(chunk, kChunkBytes);
+        }
+    }
+
+    MapNodePool(const MapNodePool&) = delete;
+    MapNodePool& operator=(const MapNodePool&) = delete;
+
+    void* allocate(size_t bytes) {
+        if (block_bytes_ == 0) {
+            block_bytes_ = round_up(bytes);
+        }
+        if (round_up(bytes) != block_bytes_) {
+            return ::operator new(bytes);
+        }
+        if (free_list_ != nullptr) {
+            FreeBlock *block = free_list_;
+            free_list_ = block->next;
+            return block;
+        }
+        if (bump_ == bump_end_) {
+            size_t chunk_bytes = kChunkBytes;
+            bool explicit_huge = false;
+            bump_ = static_cast<char*>(map_pool_memory(chunk_bytes, MemoryPoolConfig(), explicit_huge));
+            bump_end_ = bump_ + (chunk_bytes / block_bytes_) * block_bytes_;
+            chunks_.push_back(bump_);
+        }
+        void *block = bump_;
+        bump_ += block_bytes_;
+        return block;
+    }
+
+    void deallocate(void *ptr, size_t bytes) {
+        if (round_up(bytes) != block_bytes_) {
+            ::operator delete(ptr);
+            return;
+        }
+        FreeBlock *block = static_cast<FreeBlock*>(ptr);
+        block->next = free_list_;
+        free_list_ = block;
+    }
+
+private:
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    static constexpr size_t kChunkBytes = size_t(64) << 10;
+    static constexpr size_t kAlign = alignof(std::max_align_t);
+
+    // Multiple of kAlign, which is also at least sizeof(FreeBlock)
+    static size_t round_up(size_t bytes) {
+        return (bytes + kAlign - 1) & ~(kAlign - 1);
+    }
+
+    size_t block_bytes_;      // Fixed by the first allocation
+    FreeBlock *free_list_;
+    char *bump_;
+    char *bump_end_;
+    std::vector<void*> chunks_;
+};
+
+// Stateful std::map allocator drawing nodes from a MapNodePool owned by the book.
+template<typename T>
+class MapNodeAllocator {
+public:
+    using value_type = T;
+
+    explicit MapNodeAllocator(MapNodePool *pool) noexcept : pool_(pool) {}
+    template<typename U>
+    MapNodeAllocator(const MapNodeAllocator<U> &other) noexcept : pool_(other.pool()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(pool_->allocate(n * sizeof(T)));
+    }
+    void deallocate(T *ptr, size_t n) noexcept {
+        pool_->deallocate(ptr, n * sizeof(T));
+    }
+
+    MapNodePool* pool() const { return pool_; }
+
+    template<typename U>
+    bool operator==(const MapNodeAllocator<U> &other) const { return pool_ == other.pool(); }
+    template<typename U>
+    bool operator!=(const MapNodeAllocator<U> &other) const { return pool_ != other.pool(); }
+
+private:
+    MapNodePool *pool_;
+};
+
+} // namespace OrderBookSystem
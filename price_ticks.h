@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+
+namespace OrderBookSystem {
+
+// Internal price representation: an integer number of ticks of size price_precision.
+// Integer keys give cheap comparisons and exact price level identity.
+using PriceTicks = int64_t;
+
+// Converts between API prices (double) and internal ticks. Conversion only happens
+// at the API boundary; everything inside the book works in ticks.
+class TickConverter {
+public:
+    explicit TickConverter(double tick_size)
+        : tick_size_(tick_size), ticks_per_unit_(1.0 / tick_size) {
+        // Snap e.g. 1/0.01 = 99.99999... to exactly 100 so that to_price()
+        // divides two exact integers and returns the closest double to the decimal price.
+        double rounded = std::round(ticks_per_unit_);
+        if (rounded >= 1.0 && std::fabs(ticks_per_unit_ - rounded) < 1e-9 * rounded) {
+            ticks_per_unit_ = rounded;
+        }
+    }
+
+    // Rounds to the nearest tick, so 100.1 and 100.0 + 0.1 map to the same level.
+    PriceTicks to_ticks(double price) const {
+        return static_cast<PriceTicks>(std::llround(price * ticks_per_unit_));
+    }
+
+    double to_price(PriceTicks ticks) const {
+        return static_cast<double>(ticks) / ticks_per_unit_;
+    }
+
+    double tick_size() const { return tick_size_; }
+
+private:
+    double tick_size_;
+    double ticks_per_unit_;
+};
+
+} // namespace OrderBookSystem
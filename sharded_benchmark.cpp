@@ -0,0 +1,157 @@
+#include "sharded_engine.h"
+#include "workload.h"
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+
+using namespace OrderBookSystem;
+
+// Aggregate throughput of ShardedEngine as shards are added. One pre-generated workload is
+// spread over the symbols by order ID (so cancels and amends follow their order), and a single
+// pinned gateway thread routes it to the shards and drains their events.
+
+struct Options {
+    LevelStorage storage = LevelStorage::Map;
+    OrderIndexPolicy index = OrderIndexPolicy::Hash;
+    bool hft = false;
+    size_t ops = 4000000;
+    size_t symbols = 256;
+    size_t max_shards = 0; // 0: one per remaining hardware thread
+    uint64_t seed = 42;
+    int gateway_cpu = 0;   // -1 disables pinning
+    int first_cpu = 1;     // Shard i runs on first_cpu + i; -1 disables pinning
+};
+
+CommandType command_type(OpType type) {
+    switch (type) {
+        case OpType::Add:    return CommandType::Add;
+        case OpType::Cancel: return CommandType::Cancel;
+        default:             return CommandType::Amend;
+    }
+}
+
+size_t drain(ShardedEngine &engine) {
+    size_t acks = 0;
+    EngineEvent event;
+    for (size_t shard = 0; shard < engine.shard_count(); ++shard) {
+        while (engine.poll(shard, event)) {
+            acks += (event.kind == EngineEvent::Kind::Ack);
+        }
+    }
+    return acks;
+}
+
+double run(const Options &options, const std::vector<WorkloadOp> &ops, size_t num_shards) {
+    ShardedEngineConfig config;
+    config.book = OrderBookConfig(false, 10, 0.01);
+    config.book.level_storage = options.storage;
+    config.book.order_index = options.index;
+    config.num_symbols = options.symbols;
+    config.num_shards = num_shards;
+    for (size_t i = 0; i < num_shards; ++i) {
+        config.cpus.push_back(options.first_cpu < 0 ? -1 : options.first_cpu + static_cast<int>(i));
+    }
+    ShardedEngine engine(config);
+    engine.start();
+
+    size_t acked = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < ops.size(); ++i) {
+        const WorkloadOp &op = ops[i];
+        uint32_t symbol = static_cast<uint32_t>(op.order.order_id % options.symbols);
+        while (engine.try_submit(symbol, command_type(op.type), op.order) == 0) {
+            acked += drain(engine);
+            std::this_thread::yield();
+        }
+        if ((i & 63) == 0) {
+            acked += drain(engine);
+        }
+    }
+    SpinWait idle;
+    while (acked < ops.size()) {
+        size_t drained = drain(engine);
+        acked += drained;
+        if (drained == 0) {
+            idle.wait();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    engine.stop();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return static_cast<double>(ops.size()) / seconds;
+}
+
+Options parse_options(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--storage") {
+            options.storage = std::strcmp(value, "ladder") == 0 ? LevelStorage::Ladder : LevelStorage::Map;
+        } else if (arg == "--index") {
+            options.index = std::strcmp(value, "slab") == 0 ? OrderIndexPolicy::Slab : OrderIndexPolicy::Hash;
+        } else if (arg == "--workload") {
+            options.hft = std::strcmp(value, "hft") == 0;
+        } else if (arg == "--ops") {
+            options.ops = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--symbols") {
+            options.symbols = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--max-shards") {
+            options.max_shards = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--gateway-cpu") {
+            options.gateway_cpu = std::atoi(value);
+        } else if (arg == "--first-cpu") {
+            options.first_cpu = std::atoi(value);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--storage map|ladder] [--index hash|slab] [--workload uniform|hft]"
+                      << " [--ops N] [--symbols N] [--max-shards N] [--seed N] [--gateway-cpu N|-1] [--first-cpu N|-1]"
+                      << std::endl;
+            std::exit(1);
+        }
+        ++i;
+    }
+    if (options.symbols == 0) {
+        options.symbols = 1;
+    }
+    if (options.max_shards == 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        options.max_shards = hardware > 1 ? hardware - 1 : 1;
+    }
+    return options;
+}
+
+int main(int argc, char **argv) {
+    Options options = parse_options(argc, argv);
+    bool pinned = pin_current_thread(options.gateway_cpu);
+
+    WorkloadConfig workload = options.hft ? hft_workload(options.seed) : uniform_workload(options.seed);
+    std::vector<WorkloadOp> ops = WorkloadGenerator(workload).generate(options.ops);
+
+    std::cout << "--- Sharded Engine Scaling (" << options.symbols << " symbols, " << options.ops
+              << " ops; gateway " << (pinned ? "pinned" : "not pinned") << ") ---\n";
+    std::cout << std::setw(8) << "shards" << std::setw(14) << "ops/sec" << std::setw(10) << "speedup" << std::endl;
+
+    // 1, 2, 4, ... shards, finishing at max_shards
+    std::vector<size_t> shard_counts;
+    for (size_t shards = 1; shards < options.max_shards; shards *= 2) {
+        shard_counts.push_back(shards);
+    }
+    shard_counts.push_back(options.max_shards);
+
+    double baseline = 0.0;
+    for (size_t shards : shard_counts) {
+        double ops_per_sec = run(options, ops, shards);
+        baseline = baseline > 0.0 ? baseline : ops_per_sec;
+        std::cout << std::setw(8) << shards << std::fixed << std::setprecision(0) << std::setw(14) << ops_per_sec
+                  << std::setprecision(2) << std::setw(9) << ops_per_sec / baseline << "x" << std::endl;
+    }
+    return 0;
+}
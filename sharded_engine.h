@@ -0,0 +1,91 @@
+#pragma once
+
+#include "matching_engine.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace OrderBookSystem {
+
+struct ShardedEngineConfig {
+    OrderBookConfig book;         // Applied to every instrument's book
+    size_t num_symbols = 1;       // Instruments are dense IDs in [0, num_symbols)
+    size_t num_shards = 1;        // Matching threads
+    std::vector<int> cpus;        // cpus[i] pins shard i; missing or -1 leaves it unpinned
+    size_t command_capacity = 65536; // Per shard
+    size_t event_capacity = 262144;  // Per shard
+    std::vector<TopOfBook*> top_of_books; // Optional, indexed by symbol
+};
+
+// Multi-instrument engine: one OrderBook per symbol, with symbols partitioned round-robin
+// across shards. Each shard is a MatchingEngine with its own thread, rings and books, so no
+// order, level or pool memory is shared between cores. One gateway thread routes commands by
+// symbol and one consumer thread polls each shard's events; sequence numbers are per shard.
+class ShardedEngine {
+public:
+    explicit ShardedEngine(const ShardedEngineConfig &config)
+        : num_shards_(config.num_shards > 0 ? config.num_shards : 1), num_symbols_(config.num_symbols) {
+        for (size_t shard = 0; shard < num_shards_; ++shard) {
+            MatchingEngineConfig shard_config;
+            shard_config.book = config.book;
+            shard_config.num_books = (num_symbols_ + num_shards_ - 1 - shard) / num_shards_;
+            shard_config.command_capacity = config.command_capacity;
+            shard_config.event_capacity = config.event_capacity;
+            shard_config.cpu = shard < config.cpus.size() ? config.cpus[shard] : -1;
+            for (size_t symbol = shard; symbol < config.top_of_books.size(); symbol += num_shards_) {
+                shard_config.top_of_books.push_back(config.top_of_books[symbol]);
+            }
+            shards_.emplace_back(new MatchingEngine(shard_config));
+        }
+    }
+
+    ShardedEngine(const ShardedEngine&) = delete;
+    ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+    void start() {
+        for (auto &shard : shards_) {
+            shard->start();
+        }
+    }
+
+    void stop() {
+        for (auto &shard : shards_) {
+            shard->stop();
+        }
+    }
+
+    size_t shard_count() const { return num_shards_; }
+    size_t symbol_count() const { return num_symbols_; }
+
+    // Symbol <-> (shard, book within shard)
+    size_t shard_of(uint32_t symbol) const { return symbol % num_shards_; }
+    uint32_t book_of(uint32_t symbol) const { return static_cast<uint32_t>(symbol / num_shards_); }
+    uint32_t symbol_of(size_t shard, uint32_t book) const {
+        return static_cast<uint32_t>(book * num_shards_ + shard);
+    }
+
+    // Gateway side. Returns the sequence number within the symbol's shard, or 0 if its ring is full.
+    uint64_t try_submit(uint32_t symbol, CommandType type, const Order &order) {
+        return shards_[shard_of(symbol)]->try_submit(type, order, book_of(symbol));
+    }
+
+    uint64_t submit(uint32_t symbol, CommandType type, const Order &order) {
+        return shards_[shard_of(symbol)]->submit(type, order, book_of(symbol));
+    }
+
+    // Consumer side. event.book is the book within the shard; use symbol_of to map it back.
+    bool poll(size_t shard, EngineEvent &event) { return shards_[shard]->poll(event); }
+
+    MatchingEngine& shard(size_t index) { return *shards_[index]; }
+
+    // Exists once started; only safe to use while stopped.
+    OrderBook& book(uint32_t symbol) { return shards_[shard_of(symbol)]->book(book_of(symbol)); }
+
+private:
+    size_t num_shards_;
+    size_t num_symbols_;
+    std::vector<std::unique_ptr<MatchingEngine>> shards_;
+};
+
+} // namespace OrderBookSystem
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace OrderBookSystem {
+
+constexpr size_t kCacheLineSize = 64;
+
+// Bounded lock-free single-producer/single-consumer ring. Exactly one thread may push and
+// exactly one (other) thread may pop. Head and tail live on separate cache lines, and each
+// side caches the other's index so the shared line is only read when the ring looks full
+// or empty.
+template<typename T>
+class SpscQueue {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscQueue elements are copied by value");
+
+public:
+    explicit SpscQueue(size_t capacity)
+        : slots_(round_up_pow2(capacity < 2 ? 2 : capacity)), mask_(slots_.size() - 1) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false if the ring is full.
+    bool try_push(const T &value) {
+        uint64_t tail = producer_.tail.load(std::memory_order_relaxed);
+        if (tail - producer_.cached_head == slots_.size()) {
+            producer_.cached_head = consumer_.head.load(std::memory_order_acquire);
+            if (tail - producer_.cached_head == slots_.size()) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = value;
+        producer_.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false if the ring is empty.
+    bool try_pop(T &value) {
+        uint64_t head = consumer_.head.load(std::memory_order_relaxed);
+        if (head == consumer_.cached_tail) {
+            consumer_.cached_tail = producer_.tail.load(std::memory_order_acquire);
+            if (head == consumer_.cached_tail) {
+                return false;
+            }
+        }
+        value = slots_[head & mask_];
+        consumer_.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently; exact once both sides are quiescent.
+    size_t size() const {
+        return static_cast<size_t>(producer_.tail.load(std::memory_order_acquire) -
+                                   consumer_.head.load(std::memory_order_acquire));
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    static size_t round_up_pow2(size_t n) {
+        size_t result = 1;
+        while (result < n) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    struct alignas(kCacheLineSize) ProducerState {
+        std::atomic<uint64_t> tail{0};
+        uint64_t cached_head = 0;
+    };
+
+    struct alignas(kCacheLineSize) ConsumerState {
+        std::atomic<uint64_t> head{0};
+        uint64_t cached_tail = 0;
+    };
+
+    std::vector<T> slots_;
+    size_t mask_;
+    ProducerState producer_;
+    ConsumerState consumer_;
+};
+
+} // namespace OrderBookSystem
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace OrderBookSystem {
+
+// Pin the calling thread to one CPU. Returns false if cpu < 0 or pinning is unsupported.
+inline bool pin_current_thread(int cpu) {
+#ifdef __linux__
+    if (cpu < 0) {
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Spin-wait hint for busy-polling loops
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+// Busy-poll backoff: pause for a while, then start yielding so a spinning thread does not
+// starve its peer when both share a core.
+class SpinWait {
+public:
+    void wait() {
+        if (spins_ < kSpinLimit) {
+            ++spins_;
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    void reset() { spins_ = 0; }
+
+private:
+    static constexpr unsigned kSpinLimit = 1024;
+    unsigned spins_ = 0;
+};
+
+} // namespace OrderBookSystem
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "common.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace OrderBookSystem {
+
+// Reader's copy of the published top levels
+struct TopOfBookSnapshot {
+    static constexpr size_t kMaxDepth = 10;
+
+    uint64_t version;   // Number of publishes so far; increases by one per publish
+    size_t bid_count;
+    size_t ask_count;
+    PriceLevel bids[kMaxDepth];
+    PriceLevel asks[kMaxDepth];
+
+    bool has_bid() const { return bid_count > 0; }
+    bool has_ask() const { return ask_count > 0; }
+};
+
+// Top-of-book view written by one thread (the book's owner) and read by any number of threads
+// without locks. Publishing is a seqlock: the writer bumps the sequence to odd, stores the
+// levels and bumps it to even, so it never waits for readers; readers copy the levels and
+// retry if the sequence was odd or changed underneath them. The payload is held in relaxed
+// atomic words so concurrent copies are well defined.
+class alignas(64) TopOfBook {
+public:
+    static constexpr size_t kMaxDepth = TopOfBookSnapshot::kMaxDepth;
+
+    explicit TopOfBook(size_t depth = 5) : depth_(depth < kMaxDepth ? depth : kMaxDepth), sequence_(0) {
+        for (auto &word : words_) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    TopOfBook(const TopOfBook&) = delete;
+    TopOfBook& operator=(const TopOfBook&) = delete;
+
+    size_t depth() const { return depth_; }
+
+    // Writer only. Counts above depth() are truncated.
+    void publish(const PriceLevel *bids, size_t bid_count, const PriceLevel *asks, size_t ask_count) {
+        bid_count = bid_count < depth_ ? bid_count : depth_;
+        ask_count = ask_count < depth_ ? ask_count : depth_;
+
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        words_[0].store(bid_count, std::memory_order_relaxed);
+        words_[1].store(ask_count, std::memory_order_relaxed);
+        for (size_t i = 0; i < bid_count; ++i) {
+            store_level(kHeaderWords + 2 * i, bids[i]);
+        }
+        for (size_t i = 0; i < ask_count; ++i) {
+            store_level(kHeaderWords + 2 * (kMaxDepth + i), asks[i]);
+        }
+
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Any thread. Returns false if a publish was in progress or completed during the copy.
+    bool try_read(TopOfBookSnapshot &snapshot) const {
+        uint64_t before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+
+        size_t bid_count = static_cast<size_t>(words_[0].load(std::memory_order_relaxed));
+        size_t ask_count = static_cast<size_t>(words_[1].load(std::memory_order_relaxed));
+        bid_count = bid_count < kMaxDepth ? bid_count : kMaxDepth;
+        ask_count = ask_count < kMaxDepth ? ask_count : kMaxDepth;
+        for (size_t i = 0; i < bid_count; ++i) {
+            snapshot.bids[i] = load_level(kHeaderWords + 2 * i);
+        }
+        for (size_t i = 0; i < ask_count; ++i) {
+            snapshot.asks[i] = load_level(kHeaderWords + 2 * (kMaxDepth + i));
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+        snapshot.version = before / 2;
+        snapshot.bid_count = bid_count;
+        snapshot.ask_count = ask_count;
+        return true;
+    }
+
+    // Any thread. Spins until it gets a consistent copy; returns the number of retries.
+    size_t read(TopOfBookSnapshot &snapshot) const {
+        size_t retries = 0;
+        while (!try_read(snapshot)) {
+            ++retries;
+        }
+        return retries;
+    }
+
+    uint64_t version() const { return sequence_.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t kHeaderWords = 2; // bid_count, ask_count
+
+    void store_level(size_t word, const PriceLevel &level) {
+        uint64_t price_bits;
+        std::memcpy(&price_bits, &level.price, sizeof(price_bits));
+        words_[word].store(price_bits, std::memory_order_relaxed);
+        words_[word + 1].store(level.total_quantity, std::memory_order_relaxed);
+    }
+
+    PriceLevel load_level(size_t word) const {
+        PriceLevel level;
+        uint64_t price_bits = words_[word].load(std::memory_order_relaxed);
+        std::memcpy(&level.price, &price_bits, sizeof(level.price));
+        level.total_quantity = words_[word + 1].load(std::memory_order_relaxed);
+        return level;
+    }
+
+    size_t depth_;
+    std::atomic<uint64_t> sequence_;
+    std::atomic<uint64_t> words_[kHeaderWords + 4 * kMaxDepth];
+};
+
+} // namespace OrderBookSystem
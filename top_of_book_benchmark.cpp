@@ -0,0 +1,149 @@
+#include "order_book.h"
+#include "workload.h"
+#include "thread_affinity.h"
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <chrono>
+#include <atomic>
+#include <thread>
+
+using namespace OrderBookSystem;
+
+// Multi-reader contention on the seqlock top of book. The writer thread applies a
+// pre-generated workload to a book that publishes after every level change, while 0..N reader
+// threads read the top levels in a tight loop. Reports writer cost per operation and the
+// readers' aggregate read rate and retry ratio.
+
+struct Options {
+    bool hft = true;
+    size_t ops = 4000000;
+    size_t depth = 5;
+    size_t max_readers = 0; // 0: one per remaining hardware thread
+    uint64_t seed = 42;
+    int first_cpu = 0;      // Writer runs on first_cpu, reader i on first_cpu + 1 + i; -1 disables pinning
+};
+
+struct RunResult {
+    double writer_ns_per_op = 0.0;
+    uint64_t reads = 0;
+    uint64_t retries = 0;
+    double seconds = 0.0;
+};
+
+int cpu_for(const Options &options, size_t offset) {
+    return options.first_cpu < 0 ? -1 : options.first_cpu + static_cast<int>(offset);
+}
+
+RunResult run(const Options &options, const std::vector<WorkloadOp> &ops, size_t num_readers, bool publish) {
+    TopOfBook top_of_book(options.depth);
+    std::atomic<bool> start(false), done(false);
+    std::vector<uint64_t> reads(num_readers * 8, 0), retries(num_readers * 8, 0); // Padded per reader
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < num_readers; ++r) {
+        readers.emplace_back([&, r]() {
+            pin_current_thread(cpu_for(options, 1 + r));
+            TopOfBookSnapshot snapshot;
+            uint64_t local_reads = 0, local_retries = 0;
+            while (!start.load(std::memory_order_acquire)) {
+                cpu_relax();
+            }
+            while (!done.load(std::memory_order_relaxed)) {
+                local_retries += top_of_book.read(snapshot);
+                ++local_reads;
+            }
+            reads[r * 8] = local_reads;
+            retries[r * 8] = local_retries;
+        });
+    }
+
+    RunResult result;
+    std::thread writer([&]() {
+        pin_current_thread(cpu_for(options, 0));
+        OrderBook book(OrderBookConfig(false, 10, 0.01));
+        if (publish) {
+            book.set_top_of_book(&top_of_book);
+        }
+        start.store(true, std::memory_order_release);
+        auto t0 = std::chrono::steady_clock::now();
+        for (const WorkloadOp &op : ops) {
+            apply_op(book, op);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        done.store(true, std::memory_order_relaxed);
+        result.seconds = std::chrono::duration<double>(t1 - t0).count();
+        result.writer_ns_per_op = result.seconds * 1e9 / ops.size();
+    });
+    writer.join();
+    for (size_t r = 0; r < num_readers; ++r) {
+        readers[r].join();
+        result.reads += reads[r * 8];
+        result.retries += retries[r * 8];
+    }
+    return result;
+}
+
+Options parse_options(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : "";
+        if (arg == "--workload") {
+            options.hft = std::strcmp(value, "uniform") != 0;
+        } else if (arg == "--ops") {
+            options.ops = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--depth") {
+            options.depth = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--max-readers") {
+            options.max_readers = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--seed") {
+            options.seed = std::strtoull(value, nullptr, 10);
+        } else if (arg == "--first-cpu") {
+            options.first_cpu = std::atoi(value);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--workload uniform|hft] [--ops N] [--depth N]"
+                      << " [--max-readers N] [--seed N] [--first-cpu N|-1]" << std::endl;
+            std::exit(1);
+        }
+        ++i;
+    }
+    if (options.max_readers == 0) {
+        unsigned hardware = std::thread::hardware_concurrency();
+        options.max_readers = hardware > 1 ? hardware - 1 : 1;
+    }
+    return options;
+}
+
+int main(int argc, char **argv) {
+    Options options = parse_options(argc, argv);
+    WorkloadConfig workload = options.hft ? hft_workload(options.seed) : uniform_workload(options.seed);
+    std::vector<WorkloadOp> ops = WorkloadGenerator(workload).generate(options.ops);
+
+    std::cout << "--- Seqlock Top of Book Contention (depth " << options.depth << ", "
+              << options.ops << " ops) ---\n";
+    std::cout << std::setw(10) << std::left << "readers" << std::right << std::setw(14) << "writer ns/op"
+              << std::setw(16) << "reads/sec" << std::setw(12) << "retry %" << std::endl;
+
+    RunResult baseline = run(options, ops, 0, false);
+    std::cout << std::setw(10) << std::left << "off" << std::right << std::fixed << std::setprecision(2)
+              << std::setw(14) << baseline.writer_ns_per_op << std::setw(16) << "-" << std::setw(12) << "-" << std::endl;
+
+    std::vector<size_t> reader_counts;
+    for (size_t readers = 0; readers < options.max_readers; readers = readers == 0 ? 1 : readers * 2) {
+        reader_counts.push_back(readers);
+    }
+    reader_counts.push_back(options.max_readers);
+
+    for (size_t readers : reader_counts) {
+        RunResult result = run(options, ops, readers, true);
+        double retry_pct = result.reads == 0 ? 0.0 : 100.0 * result.retries / (result.reads + result.retries);
+        std::cout << std::setw(10) << std::left << readers << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << result.writer_ns_per_op << std::setprecision(0)
+                  << std::setw(16) << result.reads / result.seconds << std::setprecision(3)
+                  << std::setw(12) << retry_pct << std::endl;
+    }
+    return 0;
+}
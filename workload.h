@@ -0,0 +1,193 @@
+#pragma once
+
+#include "common.h"
+#include "price_ticks.h"
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace OrderBookSystem {
+
+enum class OpType : uint8_t { Add, Cancel, Amend };
+
+// One book operation. Cancels use order.order_id only; amends carry the new price and quantity.
+struct WorkloadOp {
+    OpType type;
+    Order order;
+};
+
+enum class PriceDistribution {
+    Uniform,  // Uniform over [min_price, max_price]
+    NearTouch // Geometric distance from a drifting touch, so most orders sit within a few ticks
+};
+
+// Seedable description of an order flow. The same config always produces the same stream.
+struct WorkloadConfig {
+    uint64_t seed = 42;
+
+    // Operation mix in percent; the rest are amends
+    int add_pct = 60;
+    int cancel_pct = 25;
+    int cancel_recent_pct = 0;     // Share of cancels that hit one of the last recent_window adds
+    size_t recent_window = 64;
+
+    // Prices
+    PriceDistribution price_distribution = PriceDistribution::Uniform;
+    double min_price = 95.0;       // Uniform only
+    double max_price = 105.0;      // Uniform only
+    double mid_price = 100.0;      // NearTouch: starting mid
+    double tick_size = 0.01;
+    double mean_touch_distance = 3.0; // NearTouch: mean ticks behind the touch for passive adds
+    int mid_move_pct = 1;          // NearTouch: chance per op that the mid moves one tick
+    int aggressive_pct = 0;        // NearTouch: share of adds priced through the touch
+    int sweep_ticks = 5;           // NearTouch: aggressive adds reach up to this many ticks through
+
+    // Quantities
+    uint64_t min_quantity = 1;
+    uint64_t max_quantity = 100;
+
+    // Bursts: every burst_period ops, burst_length ops use the burst mix (0 disables)
+    size_t burst_period = 0;
+    size_t burst_length = 0;
+    int burst_add_pct = 50;
+    int burst_cancel_pct = 50;
+    int burst_aggressive_pct = 20;
+};
+
+// The historical benchmark mix: 60/25/15 add/cancel/amend, uniform prices over 95-105
+inline WorkloadConfig uniform_workload(uint64_t seed = 42) {
+    WorkloadConfig config;
+    config.seed = seed;
+    return config;
+}
+
+// Cancel-heavy market-making flow concentrated at the touch, with sweeps and bursts
+inline WorkloadConfig hft_workload(uint64_t seed = 42) {
+    WorkloadConfig config;
+    config.seed = seed;
+    config.add_pct = 48;
+    config.cancel_pct = 42;
+    config.cancel_recent_pct = 70;
+    config.price_distribution = PriceDistribution::NearTouch;
+    config.mean_touch_distance = 2.0;
+    config.aggressive_pct = 6;
+    config.sweep_ticks = 4;
+    config.burst_period = 50000;
+    config.burst_length = 2000;
+    return config;
+}
+
+// Deterministic generator of book operations
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(const WorkloadConfig &config)
+        : config_(config), rng_(config.seed), ticks_(config.tick_size),
+          mid_ticks_(ticks_.to_ticks(config.mid_price)), next_order_id_(1), op_count_(0) {}
+
+    WorkloadOp next() {
+        bool in_burst = config_.burst_period > 0 &&
+                        (op_count_ % config_.burst_period) < config_.burst_length;
+        int add_pct = in_burst ? config_.burst_add_pct : config_.add_pct;
+        int cancel_pct = in_burst ? config_.burst_cancel_pct : config_.cancel_pct;
+        int aggressive_pct = in_burst ? config_.burst_aggressive_pct : config_.aggressive_pct;
+        uint64_t timestamp = op_count_++;
+
+        if (config_.price_distribution == PriceDistribution::NearTouch && percent() < config_.mid_move_pct) {
+            mid_ticks_ += (rng_() & 1) ? 1 : -1;
+        }
+
+        int op = percent();
+        if (op < add_pct || active_orders_.empty()) {
+            bool is_buy = (rng_() & 1) != 0;
+            uint64_t order_id = next_order_id_++;
+            active_orders_.push_back({order_id, is_buy});
+            return {OpType::Add, {order_id, is_buy, next_price(is_buy, aggressive_pct), next_quantity(), timestamp}};
+        }
+        if (op < add_pct + cancel_pct) {
+            size_t idx = pick_active(percent() < config_.cancel_recent_pct);
+            ActiveOrder cancelled = active_orders_[idx];
+            active_orders_[idx] = active_orders_.back();
+            active_orders_.pop_back();
+            return {OpType::Cancel, {cancelled.order_id, cancelled.is_buy, 0.0, 0, timestamp}};
+        }
+        ActiveOrder amended = active_orders_[pick_active(false)];
+        return {OpType::Amend, {amended.order_id, amended.is_buy, next_price(amended.is_buy, 0),
+                                next_quantity(), timestamp}};
+    }
+
+    // Pre-generate a stream so that generation is not part of the timed path
+    std::vector<WorkloadOp> generate(size_t num_ops) {
+        std::vector<WorkloadOp> ops;
+        ops.reserve(num_ops);
+        for (size_t i = 0; i < num_ops; ++i) {
+            ops.push_back(next());
+        }
+        return ops;
+    }
+
+private:
+    int percent() {
+        return static_cast<int>(rng_() % 100);
+    }
+
+    double next_price(bool is_buy, int aggressive_pct) {
+        if (config_.price_distribution == PriceDistribution::Uniform) {
+            std::uniform_real_distribution<double> price_dist(config_.min_price, config_.max_price);
+            return ticks_.to_price(ticks_.to_ticks(price_dist(rng_)));
+        }
+
+        // Bid touch is mid - 1, ask touch is mid + 1; passive orders queue behind the touch
+        PriceTicks distance;
+        if (aggressive_pct > 0 && percent() < aggressive_pct) {
+            std::uniform_int_distribution<int> through(1, config_.sweep_ticks > 0 ? config_.sweep_ticks : 1);
+            distance = -through(rng_) - 1; // Cross the spread and up to sweep_ticks beyond
+        } else {
+            std::geometric_distribution<int> behind(1.0 / (1.0 + config_.mean_touch_distance));
+            distance = behind(rng_);
+        }
+        PriceTicks price = is_buy ? mid_ticks_ - 1 - distance : mid_ticks_ + 1 + distance;
+        return ticks_.to_price(price > 1 ? price : 1);
+    }
+
+    uint64_t next_quantity() {
+        std::uniform_int_distribution<uint64_t> quantity_dist(config_.min_quantity, config_.max_quantity);
+        return quantity_dist(rng_);
+    }
+
+    size_t pick_active(bool recent) {
+        size_t size = active_orders_.size();
+        if (recent) {
+            size_t window = config_.recent_window < size ? config_.recent_window : size;
+            std::uniform_int_distribution<size_t> id_dist(size - window, size - 1);
+            return id_dist(rng_);
+        }
+        std::uniform_int_distribution<size_t> id_dist(0, size - 1);
+        return id_dist(rng_);
+    }
+
+    struct ActiveOrder {
+        uint64_t order_id;
+        bool is_buy;
+    };
+
+    WorkloadConfig config_;
+    std::mt19937_64 rng_;
+    TickConverter ticks_;
+    PriceTicks mid_ticks_;
+    uint64_t next_order_id_;
+    uint64_t op_count_;
+    std::vector<ActiveOrder> active_orders_; // Added and not yet cancelled (some may have filled)
+};
+
+// Apply one operation to any book with the OrderBook interface
+template<typename Book>
+inline void apply_op(Book &book, const WorkloadOp &op) {
+    switch (op.type) {
+        case OpType::Add:    book.add_order(op.order); break;
+        case OpType::Cancel: book.cancel_order(op.order.order_id); break;
+        case OpType::Amend:  book.amend_order(op.order.order_id, op.order.price, op.order.quantity); break;
+    }
+}
+
+} // namespace OrderBookSystem